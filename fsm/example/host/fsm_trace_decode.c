@@ -0,0 +1,412 @@
+/**
+ * @file fsm_trace_decode.c
+ * @brief 状态机跟踪导出（FSM_TraceDump）的主机端解码器
+ * @details 从串口日志中找出 FSM-TRACE-BEGIN ... FSM-TRACE-END 段（日志中夹杂的其他输出会被忽略），
+ *          对每个状态机输出：
+ *          - 时间线：每次转换、条件函数结果、未处理/延迟的事件、on_update耗时
+ *          - 各状态停留时间统计和按2的幂分桶的直方图
+ *
+ * 编译运行（在 fsm 目录下）：
+ *   gcc -O2 -I. example/host/fsm_trace_decode.c -o fsm_trace_decode
+ *   ./fsm_trace_decode uart.log          # 周期数原样显示
+ *   ./fsm_trace_decode -m 72 uart.log    # 按72MHz把周期数换算为微秒
+ */
+
+#include "fsm.h"
+#include <stdio.h>
+
+#define DECODE_MAX_STATES   256
+#define DECODE_BUCKETS      24      // 停留时间直方图桶数：<1ms, 1, 2~3, 4~7, ... 最后一桶包含更长的时间
+#define DECODE_BAR_WIDTH    40
+
+typedef struct {
+    uint32_t id;
+    char name[64];
+    uint32_t dwell_count;
+    uint32_t dwell_min;
+    uint32_t dwell_max;
+    uint64_t dwell_sum;
+    uint32_t buckets[DECODE_BUCKETS];
+    uint32_t update_count;
+    uint32_t update_max;            // on_update最大耗时（周期）
+    uint32_t guard_rejects;         // 在该状态中被拒绝的条件次数
+} DecodeState_t;
+
+typedef struct {
+    char name[64];
+    unsigned long total;            // 写入总数
+    unsigned long capacity;         // 缓冲区记录数
+    DecodeState_t states[DECODE_MAX_STATES];
+    uint32_t state_count;
+    FSM_TraceRecord_t *records;
+    uint32_t record_count;
+    uint32_t record_alloc;
+} DecodeDump_t;
+
+static const char *const decode_kind_names[] = {
+    "启动", "转换", "条件", "未处理", "延迟", "更新", "错误", "停止"
+};
+
+static double decode_mhz = 0.0;     // 0表示显示周期数
+
+static DecodeState_t *decode_find_state(DecodeDump_t *dump, uint32_t id)
+{
+    for (uint32_t i = 0; i < dump->state_count; i++) {
+        if (dump->states[i].id == id) {
+            return &dump->states[i];
+        }
+    }
+    return NULL;
+}
+
+/* 状态名称，未知状态显示ID */
+static const char *decode_state_name(DecodeDump_t *dump, uint32_t id)
+{
+    static char buf[4][16];
+    static int next = 0;
+    DecodeState_t *state = decode_find_state(dump, id);
+
+    if (state != NULL) {
+        return state->name;
+    }
+    next = (next + 1) % 4;
+    if (id == 0) {
+        snprintf(buf[next], sizeof(buf[next]), "-");
+    } else {
+        snprintf(buf[next], sizeof(buf[next]), "#%lu", (unsigned long)id);
+    }
+    return buf[next];
+}
+
+/* 耗时：给出主频时换算为微秒 */
+static const char *decode_cycles(uint32_t cycles)
+{
+    static char buf[2][24];
+    static int next = 0;
+
+    next ^= 1;
+    if (decode_mhz > 0.0) {
+        snprintf(buf[next], sizeof(buf[next]), "%.1fus", cycles / decode_mhz);
+    } else {
+        snprintf(buf[next], sizeof(buf[next]), "%lu", (unsigned long)cycles);
+    }
+    return buf[next];
+}
+
+static uint32_t decode_bucket(uint32_t ms)
+{
+    uint32_t bucket = 0;
+
+    while (ms > 0 && bucket < DECODE_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void decode_add_dwell(DecodeDump_t *dump, uint32_t id, uint32_t ms)
+{
+    DecodeState_t *state = decode_find_state(dump, id);
+
+    if (state == NULL) {
+        return;
+    }
+    if (state->dwell_count == 0 || ms < state->dwell_min) {
+        state->dwell_min = ms;
+    }
+    if (ms > state->dwell_max) {
+        state->dwell_max = ms;
+    }
+    state->dwell_count++;
+    state->dwell_sum += ms;
+    state->buckets[decode_bucket(ms)]++;
+}
+
+/* 输出时间线，同时累计停留时间和耗时统计 */
+static void decode_timeline(DecodeDump_t *dump)
+{
+    uint32_t current = 0;           // 当前状态，0表示未知（缓冲区已覆盖掉进入记录）
+    uint32_t enter_time = 0;
+    uint32_t last_time = 0;
+
+    printf("\n%10s %8s  %-6s %-6s  %-28s %-6s %s\n", "时间(ms)", "+ms", "类型", "事件", "源 -> 目标", "条件",
+           decode_mhz > 0.0 ? "耗时" : "耗时(周期)");
+
+    for (uint32_t i = 0; i < dump->record_count; i++) {
+        const FSM_TraceRecord_t *r = &dump->records[i];
+        char event[16];
+        char path[96];
+        char guard[16];
+
+        if (r->event == FSM_TRACE_EVENT_TIMEOUT) {
+            snprintf(event, sizeof(event), "超时");
+        } else {
+            snprintf(event, sizeof(event), "%u", r->event);
+        }
+        if (r->kind == FSM_TRACE_TRANSITION || r->kind == FSM_TRACE_GUARD || r->kind == FSM_TRACE_ERROR ||
+            r->kind == FSM_TRACE_START) {
+            snprintf(path, sizeof(path), "%s -> %s", decode_state_name(dump, r->from), decode_state_name(dump, r->to));
+        } else {
+            snprintf(path, sizeof(path), "%s", decode_state_name(dump, r->from));
+        }
+        if (r->kind == FSM_TRACE_ERROR) {
+            snprintf(guard, sizeof(guard), "err=%u", r->guard);
+        } else if (r->guard == FSM_TRACE_NO_GUARD) {
+            snprintf(guard, sizeof(guard), "-");
+        } else {
+            snprintf(guard, sizeof(guard), "%s", r->guard ? "通过" : "拒绝");
+        }
+
+        printf("%10lu %8lu  %-6s %-6s  %-28s %-6s %s\n", (unsigned long)r->timestamp,
+               (unsigned long)(i > 0 ? r->timestamp - last_time : 0),
+               r->kind < sizeof(decode_kind_names) / sizeof(decode_kind_names[0]) ? decode_kind_names[r->kind] : "?",
+               (r->kind == FSM_TRACE_START || r->kind == FSM_TRACE_STOP) ? "" : event, path, guard,
+               (r->kind == FSM_TRACE_TRANSITION || r->kind == FSM_TRACE_GUARD || r->kind == FSM_TRACE_UPDATE ||
+                r->kind == FSM_TRACE_ERROR) ? decode_cycles(r->cycles) : "");
+        last_time = r->timestamp;
+
+        switch (r->kind) {
+        case FSM_TRACE_START:
+            current = r->to;
+            enter_time = r->timestamp;
+            break;
+
+        case FSM_TRACE_TRANSITION:
+            if (current != 0) {
+                decode_add_dwell(dump, current, r->timestamp - enter_time);
+            }
+            current = r->to;
+            enter_time = r->timestamp;
+            break;
+
+        case FSM_TRACE_STOP:
+            if (current != 0) {
+                decode_add_dwell(dump, current, r->timestamp - enter_time);
+            }
+            current = 0;
+            break;
+
+        case FSM_TRACE_GUARD:
+            if (!r->guard && decode_find_state(dump, r->from) != NULL) {
+                decode_find_state(dump, r->from)->guard_rejects++;
+            }
+            break;
+
+        case FSM_TRACE_UPDATE: {
+            DecodeState_t *state = decode_find_state(dump, r->from);
+            if (state != NULL) {
+                state->update_count++;
+                if (r->cycles > state->update_max) {
+                    state->update_max = r->cycles;
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    if (current != 0) {
+        printf("\n最后处于 %s，至最后一条记录已停留 %lu ms\n", decode_state_name(dump, current),
+               (unsigned long)(last_time - enter_time));
+    }
+}
+
+/* 输出各状态停留时间统计和直方图 */
+static void decode_histogram(DecodeDump_t *dump)
+{
+    printf("\n%-20s %6s %8s %8s %8s %8s %10s\n", "状态", "次数", "最短ms", "平均ms", "最长ms", "条件拒绝",
+           "更新最长");
+
+    for (uint32_t i = 0; i < dump->state_count; i++) {
+        const DecodeState_t *state = &dump->states[i];
+        if (state->dwell_count == 0 && state->update_count == 0 && state->guard_rejects == 0) {
+            continue;
+        }
+        printf("%-20s %6lu %8lu %8lu %8lu %8lu %10s\n", state->name, (unsigned long)state->dwell_count,
+               (unsigned long)state->dwell_min,
+               (unsigned long)(state->dwell_count ? state->dwell_sum / state->dwell_count : 0),
+               (unsigned long)state->dwell_max, (unsigned long)state->guard_rejects,
+               state->update_count ? decode_cycles(state->update_max) : "-");
+    }
+
+    for (uint32_t i = 0; i < dump->state_count; i++) {
+        const DecodeState_t *state = &dump->states[i];
+        uint32_t first = DECODE_BUCKETS;
+        uint32_t last = 0;
+        uint32_t peak = 0;
+
+        if (state->dwell_count == 0) {
+            continue;
+        }
+        for (uint32_t b = 0; b < DECODE_BUCKETS; b++) {
+            if (state->buckets[b] > 0) {
+                if (first == DECODE_BUCKETS) {
+                    first = b;
+                }
+                last = b;
+                if (state->buckets[b] > peak) {
+                    peak = state->buckets[b];
+                }
+            }
+        }
+
+        printf("\n%s 停留时间(ms):\n", state->name);
+        for (uint32_t b = first; b <= last; b++) {
+            char range[48];
+            if (b == 0) {
+                snprintf(range, sizeof(range), "0");
+            } else if (b == DECODE_BUCKETS - 1) {
+                snprintf(range, sizeof(range), ">=%lu", 1UL << (b - 1));
+            } else {
+                snprintf(range, sizeof(range), "%lu-%lu", 1UL << (b - 1), (1UL << b) - 1);
+            }
+            printf("  %15s | ", range);
+            uint32_t width = (uint32_t)((uint64_t)state->buckets[b] * DECODE_BAR_WIDTH / peak);
+            if (width == 0 && state->buckets[b] > 0) {
+                width = 1;
+            }
+            for (uint32_t n = 0; n < width; n++) {
+                putchar('#');
+            }
+            printf(" %lu\n", (unsigned long)state->buckets[b]);
+        }
+    }
+}
+
+static void decode_report(DecodeDump_t *dump)
+{
+    printf("==== 状态机 %s：记录 %lu 条", dump->name, (unsigned long)dump->record_count);
+    if (dump->total > dump->record_count) {
+        printf("（共写入 %lu 条，较早的 %lu 条已被覆盖）", dump->total, dump->total - dump->record_count);
+    }
+    printf(" ====\n");
+
+    decode_timeline(dump);
+    decode_histogram(dump);
+    printf("\n");
+}
+
+/* 去掉行尾的\r\n */
+static void decode_chomp(char *line)
+{
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+}
+
+static void decode_file(FILE *fp)
+{
+    static DecodeDump_t dump;
+    char line[512];
+    int inside = 0;
+    int dumps = 0;
+    size_t prefix = 0;              // 日志行前缀长度（与BEGIN行相同）
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        decode_chomp(line);
+
+        // 日志行可能带有时间戳等前缀
+        char *begin = strstr(line, "FSM-TRACE-BEGIN ");
+        if (begin != NULL) {
+            int name_pos = 0;
+            free(dump.records);
+            memset(&dump, 0, sizeof(dump));
+            if (sscanf(begin, "FSM-TRACE-BEGIN %lu %lu %n", &dump.total, &dump.capacity, &name_pos) >= 2 &&
+                name_pos > 0) {
+                strncpy(dump.name, begin + name_pos, sizeof(dump.name) - 1);
+            }
+            prefix = (size_t)(begin - line);
+            inside = 1;
+            continue;
+        }
+        if (!inside) {
+            continue;
+        }
+        if (strstr(line, "FSM-TRACE-END") != NULL) {
+            decode_report(&dump);
+            inside = 0;
+            dumps++;
+            continue;
+        }
+
+        char *text = (strlen(line) >= prefix) ? line + prefix : line;
+        unsigned long id;
+        int name_pos = 0;
+        unsigned long timestamp, cycles;
+        unsigned int kind, from, to, event, guard;
+
+        if (text[0] == 'S' && sscanf(text, "S %lu %n", &id, &name_pos) >= 1 && name_pos > 0) {
+            if (dump.state_count < DECODE_MAX_STATES) {
+                DecodeState_t *state = &dump.states[dump.state_count++];
+                state->id = (uint32_t)id;
+                strncpy(state->name, text + name_pos, sizeof(state->name) - 1);
+            }
+        } else if (text[0] == 'R' && sscanf(text, "R %lx %lx %x %x %x %x %x", &timestamp, &cycles, &kind,
+                                            &from, &to, &event, &guard) == 7) {
+            if (dump.record_count == dump.record_alloc) {
+                dump.record_alloc = dump.record_alloc ? dump.record_alloc * 2 : 256;
+                dump.records = (FSM_TraceRecord_t *)realloc(dump.records, dump.record_alloc * sizeof(FSM_TraceRecord_t));
+                if (dump.records == NULL) {
+                    fprintf(stderr, "内存不足\n");
+                    exit(1);
+                }
+            }
+            FSM_TraceRecord_t *r = &dump.records[dump.record_count++];
+            r->timestamp = (uint32_t)timestamp;
+            r->cycles = (uint32_t)cycles;
+            r->kind = (uint8_t)kind;
+            r->from = (uint16_t)from;
+            r->to = (uint16_t)to;
+            r->event = (uint16_t)event;
+            r->guard = (uint8_t)guard;
+        }
+    }
+
+    // 导出被截断（如导出途中复位）时仍解码已收到的部分
+    if (inside) {
+        printf("(导出不完整)\n");
+        decode_report(&dump);
+        dumps++;
+    }
+    if (dumps == 0) {
+        fprintf(stderr, "未找到 FSM-TRACE-BEGIN\n");
+    }
+    free(dump.records);
+    dump.records = NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            decode_mhz = atof(argv[++i]);
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "用法: %s [-m CPU主频MHz] [日志文件]\n", argv[0]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE *fp = stdin;
+    if (path != NULL && strcmp(path, "-") != 0) {
+        fp = fopen(path, "r");
+        if (fp == NULL) {
+            perror(path);
+            return 1;
+        }
+    }
+
+    decode_file(fp);
+
+    if (fp != stdin) {
+        fclose(fp);
+    }
+    return 0;
+}
@@ -7,6 +7,14 @@
  */
 
 #include "fsm.h"
+#if FSM_CONFIG_TRACE
+#include <stdio.h>
+#endif
+
+// 禁止使用堆时，本模块中任何堆函数调用都会编译失败
+#if FSM_CONFIG_NO_HEAP && defined(__GNUC__)
+#pragma GCC poison malloc calloc realloc free
+#endif
 
 // 错误字符串数组
 static const char* fsm_error_strings[] = {
@@ -19,9 +27,64 @@ static const char* fsm_error_strings[] = {
     "状态处于活动状态",         // FSM_ERR_STATE_ACTIVE
     "事件未处理",               // FSM_ERR_EVENT_NOT_HANDLED
     "超时错误",                 // FSM_ERR_TIMEOUT
+    "事件队列已满",             // FSM_ERR_QUEUE_FULL
     "未知错误"                  // FSM_ERR_UNKNOWN
 };
 
+#if FSM_CONFIG_TRACE
+#if defined(DWT) && defined(DWT_CTRL_CYCCNTENA_Msk)
+/* 默认周期计数器：DWT周期计数器（由DWT_Delay_Init()使能） */
+static uint32_t FSM_DwtCycles(void)
+{
+    return DWT->CYCCNT;
+}
+static FSM_CycleCounter_t fsm_cycle_counter = FSM_DwtCycles;
+#else
+static FSM_CycleCounter_t fsm_cycle_counter = NULL;
+#endif
+
+/**
+ * @brief 读取周期计数器
+ */
+static inline uint32_t FSM_ReadCycles(void)
+{
+    return fsm_cycle_counter ? fsm_cycle_counter() : 0U;
+}
+
+/**
+ * @brief 写入一条跟踪记录（未挂跟踪缓冲区时不记录）
+ */
+static void FSM_TraceWrite(
+    FSM_Machine_t* machine,
+    FSM_TraceKind_t kind,
+    const FSM_State_t* from,
+    FSM_StateID_t to,
+    FSM_EventID_t event_id,
+    uint8_t guard,
+    uint32_t cycles)
+{
+    FSM_Trace_t* trace = machine->trace;
+    if (!trace) return;
+    
+    FSM_TraceRecord_t* record = &trace->records[trace->head & (FSM_CONFIG_TRACE_SIZE - 1U)];
+    record->timestamp = machine->time_now;
+    record->cycles = cycles;
+    record->from = (uint16_t)(from ? from->id : 0U);
+    record->to = (uint16_t)to;
+    record->event = (uint16_t)event_id;
+    record->kind = (uint8_t)kind;
+    record->guard = guard;
+    trace->head++;
+}
+
+#define FSM_TRACE_CYCLES()  FSM_ReadCycles()
+#define FSM_TRACE(machine, kind, from, to, event_id, guard, cycles) \
+    FSM_TraceWrite((machine), (kind), (from), (to), (event_id), (guard), (cycles))
+#else
+#define FSM_TRACE_CYCLES()  0U
+#define FSM_TRACE(machine, kind, from, to, event_id, guard, cycles) ((void)(cycles))
+#endif /* FSM_CONFIG_TRACE */
+
 /**
  * @brief 查找状态
  * @param machine 状态机实例
@@ -32,6 +95,14 @@ static FSM_State_t* FSM_FindState(FSM_Machine_t* machine, FSM_StateID_t state_id
 {
     if (!machine) return NULL;
     
+    // 编译态：状态ID即表下标+1
+    if (machine->definition) {
+        if (state_id == 0 || state_id > machine->definition->state_count) {
+            return NULL;
+        }
+        return (FSM_State_t*)&machine->definition->states[state_id - 1];
+    }
+    
     FSM_State_t* state = machine->states;
     while (state) {
         if (state->id == state_id) {
@@ -39,375 +110,1538 @@ static FSM_State_t* FSM_FindState(FSM_Machine_t* machine, FSM_StateID_t state_id
         }
         state = state->next;
     }
-    return NULL;
+    return NULL;
+}
+
+#define FSM_WHEEL_MASK      (FSM_CONFIG_WHEEL_SLOTS - 1U)
+
+/* 共享时间轮：所有状态机的定时器按到期节拍挂在对应槽的双向链表上 */
+static struct {
+    FSM_Timer_t* slots[FSM_CONFIG_WHEEL_SLOTS];
+    uint32_t tick;                  // 已处理到的节拍
+    uint32_t time_ms;               // 已处理到的系统时间
+    uint8_t started;                // 是否已调用过FSM_TimerTick
+} fsm_wheel;
+
+/**
+ * @brief 定时器挂到时间轮上（调用者须处于临界区）
+ */
+static void FSM_WheelInsert(FSM_Timer_t* timer)
+{
+    FSM_Timer_t** slot = &fsm_wheel.slots[timer->expire & FSM_WHEEL_MASK];
+    
+    timer->prev = NULL;
+    timer->next = *slot;
+    if (*slot) {
+        (*slot)->prev = timer;
+    }
+    *slot = timer;
+    timer->active = 1;
+}
+
+/**
+ * @brief 定时器从时间轮上摘下（调用者须处于临界区）
+ */
+static void FSM_WheelRemove(FSM_Timer_t* timer)
+{
+    if (!timer->active) return;
+    
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        fsm_wheel.slots[timer->expire & FSM_WHEEL_MASK] = timer->next;
+    }
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->active = 0;
+}
+
+/**
+ * @brief 毫秒数换算为时间轮节拍（向上取整）
+ */
+static uint32_t FSM_MsToTicks(uint32_t ms)
+{
+    return (ms + FSM_CONFIG_WHEEL_TICK_MS - 1U) / FSM_CONFIG_WHEEL_TICK_MS;
+}
+
+/**
+ * @brief 启动（或重新启动）定时器，首次到期不早于delay_ms
+ */
+static void FSM_TimerArm(
+    FSM_Machine_t* machine,
+    FSM_Timer_t* timer,
+    FSM_EventID_t event_id,
+    FSM_UserData_t data,
+    uint32_t delay_ms,
+    uint32_t period_ms)
+{
+    uint32_t irq_state = FSM_CRITICAL_ENTER();
+
+    // 当前节拍已过去的部分也要计入，否则最多提前一个节拍到期。状态机时间落在当前节拍之后时按实际值计，
+    // 否则（时间轮未启动，或状态机时间只是同步自时间轮）无法得知，按最坏情况计为一个节拍减1ms
+    uint32_t partial = machine->time_now - fsm_wheel.time_ms;
+    if (!fsm_wheel.started || (int32_t)partial <= 0) {
+        partial = FSM_CONFIG_WHEEL_TICK_MS - 1U;
+    }
+    uint32_t delay = FSM_MsToTicks(partial + delay_ms);
+
+    FSM_WheelRemove(timer);
+    timer->machine = machine;
+    timer->event = event_id;
+    timer->data = data;
+    timer->expire = fsm_wheel.tick + (delay ? delay : 1U);
+    timer->period = period_ms ? (FSM_MsToTicks(period_ms) ? FSM_MsToTicks(period_ms) : 1U) : 0U;
+    FSM_WheelInsert(timer);
+    FSM_CRITICAL_EXIT(irq_state);
+}
+
+/**
+ * @brief 停止定时器
+ */
+static void FSM_TimerCancel(FSM_Timer_t* timer)
+{
+    uint32_t irq_state = FSM_CRITICAL_ENTER();
+    FSM_WheelRemove(timer);
+    FSM_CRITICAL_EXIT(irq_state);
+}
+
+/**
+ * @brief 停止状态机的所有定时器（包括状态超时定时器）
+ */
+static void FSM_CancelAllTimers(FSM_Machine_t* machine)
+{
+    for (uint32_t i = 0; i <= FSM_CONFIG_MAX_TIMERS; i++) {
+        FSM_TimerCancel(&machine->timers[i]);
+    }
+}
+
+/**
+ * @brief 事件入队尾（可在中断中调用）
+ * @param machine 状态机实例
+ * @param event 事件
+ * @return FSM_OK表示成功，FSM_ERR_QUEUE_FULL表示队列已满
+ */
+static FSM_Error_t FSM_QueueEvent(FSM_Machine_t* machine, const FSM_Event_t* event)
+{
+    FSM_Error_t result = FSM_OK;
+    
+    uint32_t irq_state = FSM_CRITICAL_ENTER();
+    if (machine->queue_count >= FSM_CONFIG_EVENT_QUEUE_SIZE) {
+        machine->event_drops++;
+        result = FSM_ERR_QUEUE_FULL;
+    } else {
+        machine->event_queue[(machine->queue_head + machine->queue_count) % FSM_CONFIG_EVENT_QUEUE_SIZE] = *event;
+        machine->queue_count++;
+    }
+    FSM_CRITICAL_EXIT(irq_state);
+    
+    return result;
+}
+
+/**
+ * @brief 从队首取出一个事件
+ * @return 1表示取到，0表示队列为空
+ */
+static int FSM_DequeueEvent(FSM_Machine_t* machine, FSM_Event_t* event)
+{
+    int found = 0;
+    
+    uint32_t irq_state = FSM_CRITICAL_ENTER();
+    if (machine->queue_count > 0) {
+        *event = machine->event_queue[machine->queue_head];
+        machine->queue_head = (uint8_t)((machine->queue_head + 1U) % FSM_CONFIG_EVENT_QUEUE_SIZE);
+        machine->queue_count--;
+        found = 1;
+    }
+    FSM_CRITICAL_EXIT(irq_state);
+    
+    return found;
+}
+
+/**
+ * @brief 内部事件入队（只在任务上下文中访问，不需要临界区）
+ * @param machine 状态机实例
+ * @param event 事件
+ * @param front 1表示插入队首（重新处理的延迟事件），0表示插入队尾
+ * @return FSM_OK表示成功，FSM_ERR_QUEUE_FULL表示队列已满
+ */
+static FSM_Error_t FSM_QueueInternal(FSM_Machine_t* machine, const FSM_Event_t* event, int front)
+{
+    if (machine->internal_count >= FSM_CONFIG_INTERNAL_QUEUE_SIZE) {
+        uint32_t irq_state = FSM_CRITICAL_ENTER();  // event_drops也会在中断中修改
+        machine->event_drops++;
+        FSM_CRITICAL_EXIT(irq_state);
+        return FSM_ERR_QUEUE_FULL;
+    }
+    
+    if (front) {
+        machine->internal_head = (uint8_t)((machine->internal_head + FSM_CONFIG_INTERNAL_QUEUE_SIZE - 1U) %
+                                           FSM_CONFIG_INTERNAL_QUEUE_SIZE);
+        machine->internal_queue[machine->internal_head] = *event;
+    } else {
+        machine->internal_queue[(machine->internal_head + machine->internal_count) %
+                                FSM_CONFIG_INTERNAL_QUEUE_SIZE] = *event;
+    }
+    machine->internal_count++;
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 状态改变后把延迟事件按原顺序放回内部队列队首
+ */
+static void FSM_RecallDeferred(FSM_Machine_t* machine)
+{
+    while (machine->defer_count > 0) {
+        if (FSM_QueueInternal(machine, &machine->defer_queue[machine->defer_count - 1], 1) != FSM_OK) {
+            break;  // 队列已满，剩余的延迟事件留到下次状态改变
+        }
+        machine->defer_count--;
+    }
+}
+
+/**
+ * @brief 检查所有状态的嵌套深度不超过FSM_CONFIG_MAX_DEPTH（同时排除父状态成环）
+ * @param machine 状态机实例
+ * @return 1表示合法，0表示超出
+ */
+static int FSM_CheckDepth(FSM_Machine_t* machine)
+{
+    const FSM_State_t* state = machine->definition ? machine->definition->states : machine->states;
+    uint32_t index = 0;
+    
+    while (state) {
+        uint32_t depth = 0;
+        for (const FSM_State_t* p = state->parent; p; p = p->parent) {
+            if (++depth > FSM_CONFIG_MAX_DEPTH) {
+                return 0;
+            }
+        }
+        
+        if (machine->definition) {
+            state = (++index < machine->definition->state_count) ? &machine->definition->states[index] : NULL;
+        } else {
+            state = state->next;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 查找两个状态的最近公共祖先
+ * @param a 转换的源状态
+ * @param b 转换的目标状态
+ * @return 公共祖先，NULL表示根；源或目标本身不算（自转换和父子间转换都退出并重新进入）
+ */
+static FSM_State_t* FSM_FindLCA(FSM_State_t* a, FSM_State_t* b)
+{
+    FSM_State_t* x = a;
+    FSM_State_t* y = b;
+    uint32_t depth_x = 0;
+    uint32_t depth_y = 0;
+    
+    for (FSM_State_t* p = x->parent; p; p = p->parent) depth_x++;
+    for (FSM_State_t* p = y->parent; p; p = p->parent) depth_y++;
+    
+    while (depth_x > depth_y) { x = x->parent; depth_x--; }
+    while (depth_y > depth_x) { y = y->parent; depth_y--; }
+    while (x != y) {
+        x = x->parent;
+        y = y->parent;
+    }
+    
+    if (x && (x == a || x == b)) {
+        x = x->parent;
+    }
+    return x;
+}
+
+/**
+ * @brief 从指定状态向下找到实际进入的叶子状态（初始子状态或历史状态）
+ */
+static FSM_State_t* FSM_ResolveLeaf(FSM_State_t* state)
+{
+    while (state->initial_child) {
+        if (state->history_mode != FSM_HISTORY_NONE && state->history) {
+            state = state->history;
+        } else {
+            state = state->initial_child;
+        }
+    }
+    return state;
+}
+
+/**
+ * @brief 从当前叶子状态逐级退出到（不含）公共祖先，并记录被退出的父状态的历史状态
+ * @param machine 状态机实例
+ * @param lca 公共祖先，NULL表示退出到根
+ * @param next_state 转换的目标状态（可能是父状态，实际进入的叶子在退出后才解析）
+ * @return FSM_OK表示成功，其他表示错误
+ */
+static FSM_Error_t FSM_ExitTo(FSM_Machine_t* machine, FSM_State_t* lca, FSM_State_t* next_state)
+{
+    FSM_State_t* leaf = machine->current_state;
+    
+    for (FSM_State_t* state = leaf; state && state != lca; state = state->parent) {
+        if (state->on_exit) {
+            FSM_Error_t exit_result = state->on_exit(machine, state, next_state, machine->user_data);
+            if (exit_result != FSM_OK) {
+                return exit_result;
+            }
+        }
+        
+        // 只记录本次被退出的父状态的历史，公共祖先没有退出，等它自己退出时再记录；
+        // 编译态的状态表是只读的，不记录历史
+        FSM_State_t* parent = state->parent;
+        if (parent && parent != lca && !machine->definition) {
+            if (parent->history_mode == FSM_HISTORY_SHALLOW) {
+                parent->history = state;
+            } else if (parent->history_mode == FSM_HISTORY_DEEP) {
+                parent->history = leaf;
+            }
+        }
+    }
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 切换到叶子状态，并从公共祖先之下逐级进入到该状态
+ * @param machine 状态机实例
+ * @param leaf 目标叶子状态
+ * @param lca 公共祖先，NULL表示从根进入
+ * @param prev_state 离开的叶子状态
+ * @return FSM_OK表示成功，其他表示错误
+ */
+static FSM_Error_t FSM_EnterFrom(
+    FSM_Machine_t* machine,
+    FSM_State_t* leaf,
+    FSM_State_t* lca,
+    FSM_State_t* prev_state)
+{
+    FSM_State_t* path[FSM_CONFIG_MAX_DEPTH + 1];
+    uint32_t count = 0;
+    
+    for (FSM_State_t* state = leaf; state && state != lca; state = state->parent) {
+        path[count++] = state;
+    }
+    
+    // 切换到目标状态（编译态的状态表是只读的，不写enter_time）
+    machine->current_state = leaf;
+    machine->enter_time = machine->time_now;
+    if (!machine->definition) {
+        leaf->enter_time = machine->time_now;
+    }
+    
+    // 状态超时在时间轮上计时，序号用于丢弃上一次进入时投递的过期超时事件；
+    // 机器组的超时由FSM_GroupUpdate扫描超时时刻数组
+    machine->timeout_seq++;
+    if (machine->group) {
+        // 不使用时间轮
+    } else if (leaf->timeout > 0 && leaf->timeout_state) {
+        FSM_TimerArm(machine, &machine->timers[FSM_CONFIG_MAX_TIMERS], FSM_EVENT_STATE_TIMEOUT,
+                     (FSM_UserData_t)(uintptr_t)machine->timeout_seq, leaf->timeout, 0);
+    } else {
+        FSM_TimerCancel(&machine->timers[FSM_CONFIG_MAX_TIMERS]);
+    }
+    
+    // 由外向内执行进入回调
+    while (count > 0) {
+        FSM_State_t* state = path[--count];
+        if (state->on_enter) {
+            FSM_Error_t enter_result = state->on_enter(machine, state, prev_state, machine->user_data);
+            if (enter_result != FSM_OK) {
+                return enter_result;
+            }
+        }
+    }
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 执行状态转换
+ * @param machine 状态机实例
+ * @param source_state 声明该转换的状态（当前叶子状态或其父状态）
+ * @param transition 转换规则
+ * @param event 触发事件
+ * @return FSM_OK表示成功，其他表示错误
+ */
+static FSM_Error_t FSM_DoTransition(
+    FSM_Machine_t* machine,
+    FSM_State_t* source_state,
+    FSM_Transition_t* transition,
+    FSM_Event_t* event)
+{
+    if (!machine || !source_state || !transition) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 找到目标状态，目标为父状态时进入其初始子状态或历史状态
+    FSM_State_t* target_state = FSM_FindState(machine, transition->target);
+    if (!target_state) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    FSM_State_t* leaf = target_state;
+    FSM_State_t* lca = FSM_FindLCA(source_state, target_state);
+    
+    // 保存当前状态作为上一个状态
+    machine->previous_state = machine->current_state;
+    uint32_t start_cycles = FSM_TRACE_CYCLES();
+    
+    // 从当前状态逐级退出到公共祖先；退出时已记录历史，此后再解析实际进入的叶子状态，
+    // 转换到自身所在的父状态时才能恢复刚离开的子状态
+    FSM_Error_t result = FSM_ExitTo(machine, lca, target_state);
+    if (result == FSM_OK) {
+        leaf = FSM_ResolveLeaf(target_state);
+    }
+    
+    // 如果转换有动作函数，执行动作
+    if (result == FSM_OK && transition->action) {
+        result = transition->action(machine, transition, event, machine->user_data);
+    }
+    
+    // 从公共祖先逐级进入目标状态
+    if (result == FSM_OK) {
+        result = FSM_EnterFrom(machine, leaf, lca, machine->previous_state);
+    }
+    
+    FSM_TRACE(machine, result == FSM_OK ? FSM_TRACE_TRANSITION : FSM_TRACE_ERROR,
+              machine->previous_state, leaf->id, event->id,
+              result != FSM_OK ? (uint8_t)result : (transition->guard ? 1U : FSM_TRACE_NO_GUARD),
+              FSM_TRACE_CYCLES() - start_cycles);
+    if (result != FSM_OK) {
+        return result;
+    }
+    
+    // 增加转换计数
+    machine->transition_count++;
+    
+    // 状态已改变，延迟的事件重新处理
+    FSM_RecallDeferred(machine);
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 执行当前状态的超时转换
+ */
+static FSM_Error_t FSM_DoTimeout(FSM_Machine_t* machine)
+{
+    // 创建超时转换
+    FSM_Transition_t timeout_transition;
+    memset(&timeout_transition, 0, sizeof(FSM_Transition_t));
+    timeout_transition.source = machine->current_state->id;
+    timeout_transition.target = machine->current_state->timeout_state->id;
+    
+    // 创建超时事件
+    FSM_Event_t timeout_event;
+    memset(&timeout_event, 0, sizeof(FSM_Event_t));
+    timeout_event.id = FSM_EVENT_STATE_TIMEOUT;
+    
+    // 执行超时转换
+    return FSM_DoTransition(machine, machine->current_state, &timeout_transition, &timeout_event);
+}
+
+/**
+ * @brief 在指定状态中查找与事件匹配且条件满足的转换
+ * @param machine 状态机实例
+ * @param state 状态
+ * @param event 事件
+ * @return 转换规则，NULL表示该状态不处理此事件
+ */
+static FSM_Transition_t* FSM_MatchTransition(
+    FSM_Machine_t* machine,
+    FSM_State_t* state,
+    FSM_Event_t* event)
+{
+    // 编译态直接按(状态,事件)查表，候选转换经next链接
+    FSM_Transition_t* transition = state->transitions;
+    if (machine->definition) {
+        const FSM_Definition_t* def = machine->definition;
+        if (event->id >= def->event_count) {
+            return NULL;
+        }
+        transition = (FSM_Transition_t*)&def->table[(state->id - 1) * def->event_count + event->id];
+        if (transition->target == 0) {
+            return NULL;
+        }
+    }
+    
+    while (transition) {
+        // 检查事件是否匹配，条件是否满足
+        if (transition->event == event->id) {
+            if (!transition->guard) {
+                return transition;
+            }
+            
+            uint32_t start_cycles = FSM_TRACE_CYCLES();
+            int passed = transition->guard(machine, transition, event, machine->user_data) ? 1 : 0;
+            FSM_TRACE(machine, FSM_TRACE_GUARD, machine->current_state, transition->target, event->id,
+                      (uint8_t)passed, FSM_TRACE_CYCLES() - start_cycles);
+            if (passed) {
+                return transition;
+            }
+        }
+        transition = transition->next;
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief 处理一个事件：从当前状态开始查找转换，未处理的事件逐级交给父状态
+ * @param machine 状态机实例
+ * @param event 事件
+ * @return FSM_OK表示成功（包括事件被延迟），其他表示错误
+ */
+static FSM_Error_t FSM_Dispatch(FSM_Machine_t* machine, FSM_Event_t* event)
+{
+    FSM_Error_t result = FSM_ERR_EVENT_NOT_HANDLED;
+    uint32_t deferred = 0;
+    
+    machine->in_dispatch = 1;
+    
+    // 时间轮投递的状态超时：只处理本次进入当前状态时启动的那一次
+    if (event->id == FSM_EVENT_STATE_TIMEOUT) {
+        result = FSM_OK;
+        if ((uint32_t)(uintptr_t)event->data == machine->timeout_seq &&
+            machine->current_state->timeout > 0 && machine->current_state->timeout_state) {
+            result = FSM_DoTimeout(machine);
+        }
+        machine->in_dispatch = 0;
+        return result;
+    }
+    
+    for (FSM_State_t* state = machine->current_state; state; state = state->parent) {
+        FSM_Transition_t* transition = FSM_MatchTransition(machine, state, event);
+        if (transition) {
+            result = FSM_DoTransition(machine, state, transition, event);
+            break;
+        }
+        if (event->id < 32U) {
+            deferred |= state->defer_mask & (1UL << event->id);
+        }
+    }
+    
+    // 没有状态处理但当前状态延迟了该事件：暂存到状态改变后
+    if (result == FSM_ERR_EVENT_NOT_HANDLED && deferred) {
+        if (machine->defer_count < FSM_CONFIG_DEFER_QUEUE_SIZE) {
+            machine->defer_queue[machine->defer_count++] = *event;
+        } else {
+            machine->event_drops++;
+        }
+        FSM_TRACE(machine, FSM_TRACE_DEFERRED, machine->current_state, 0, event->id, FSM_TRACE_NO_GUARD, 0);
+        result = FSM_OK;
+    } else if (result == FSM_ERR_EVENT_NOT_HANDLED) {
+        FSM_TRACE(machine, FSM_TRACE_UNHANDLED, machine->current_state, 0, event->id, FSM_TRACE_NO_GUARD, 0);
+    }
+    
+    machine->in_dispatch = 0;
+    
+    return result;
+}
+
+/**
+ * @brief 处理本次调用中回调发送的事件和重新放回的延迟事件（运行到完成）
+ * @return 处理的事件数
+ * @note 这些事件在内部队列中，不会被中断投递到事件队列的事件挤占
+ */
+static uint32_t FSM_RunToCompletion(FSM_Machine_t* machine)
+{
+    uint32_t processed = 0;
+    
+    while (machine->internal_count > 0 && machine->current_state) {
+        FSM_Event_t event = machine->internal_queue[machine->internal_head];
+        machine->internal_head = (uint8_t)((machine->internal_head + 1U) % FSM_CONFIG_INTERNAL_QUEUE_SIZE);
+        machine->internal_count--;
+        FSM_Dispatch(machine, &event);
+        processed++;
+    }
+    
+    // 状态机在回调中被停止时丢弃剩余的内部事件
+    machine->internal_count = 0;
+    
+    return processed;
+}
+
+/**
+ * @brief 分配一个状态：静态状态机从状态池中取，否则从堆分配
+ */
+static FSM_State_t* FSM_AllocState(FSM_Machine_t* machine)
+{
+    if (machine->state_pool) {
+        return machine->state_count < machine->state_capacity ? &machine->state_pool[machine->state_count] : NULL;
+    }
+#if FSM_CONFIG_NO_HEAP
+    return NULL;
+#else
+    return (FSM_State_t*)malloc(sizeof(FSM_State_t));
+#endif
+}
+
+/**
+ * @brief 分配一条转换：静态状态机从转换池中取，否则从堆分配
+ */
+static FSM_Transition_t* FSM_AllocTransition(FSM_Machine_t* machine)
+{
+    if (machine->state_pool) {
+        if (machine->transition_used >= machine->transition_capacity) {
+            return NULL;
+        }
+        return &machine->transition_pool[machine->transition_used++];
+    }
+#if FSM_CONFIG_NO_HEAP
+    return NULL;
+#else
+    return (FSM_Transition_t*)malloc(sizeof(FSM_Transition_t));
+#endif
+}
+
+#if !FSM_CONFIG_NO_HEAP
+/**
+ * @brief 创建状态机
+ */
+FSM_Machine_t* FSM_Create(const char* name, FSM_UserData_t user_data)
+{
+    if (!name) return NULL;
+    
+    // 分配内存
+    FSM_Machine_t* machine = (FSM_Machine_t*)malloc(sizeof(FSM_Machine_t));
+    if (!machine) return NULL;
+    
+    // 初始化状态机
+    memset(machine, 0, sizeof(FSM_Machine_t));
+    strncpy(machine->name, name, sizeof(machine->name) - 1);
+    machine->user_data = user_data;
+    
+    return machine;
+}
+#endif /* !FSM_CONFIG_NO_HEAP */
+
+/**
+ * @brief 在调用者提供的存储中创建状态机
+ */
+FSM_Machine_t* FSM_CreateStatic(
+    FSM_Machine_t* machine,
+    FSM_State_t* states,
+    uint16_t max_states,
+    FSM_Transition_t* transitions,
+    uint16_t max_transitions,
+    const char* name,
+    FSM_UserData_t user_data)
+{
+    if (!machine || !states || max_states == 0 || (!transitions && max_transitions > 0) || !name) {
+        return NULL;
+    }
+    
+    memset(machine, 0, sizeof(FSM_Machine_t));
+    strncpy(machine->name, name, sizeof(machine->name) - 1);
+    machine->user_data = user_data;
+    machine->state_pool = states;
+    machine->state_capacity = max_states;
+    machine->transition_pool = transitions;
+    machine->transition_capacity = max_transitions;
+    
+    return machine;
+}
+
+/**
+ * @brief 用编译态定义初始化状态机
+ */
+FSM_Error_t FSM_InitCompiled(
+    FSM_Machine_t* machine,
+    const FSM_Definition_t* definition,
+    const char* name,
+    FSM_UserData_t user_data)
+{
+    if (!machine || !definition || !name || !definition->states || !definition->table ||
+        definition->state_count == 0 || definition->event_count == 0) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 检查状态表顺序，保证按ID下标查找成立
+    for (uint32_t i = 0; i < definition->state_count; i++) {
+        if (definition->states[i].id != i + 1) {
+            return FSM_ERR_PARAM_INVALID;
+        }
+    }
+    
+    memset(machine, 0, sizeof(FSM_Machine_t));
+    strncpy(machine->name, name, sizeof(machine->name) - 1);
+    machine->user_data = user_data;
+    machine->definition = definition;
+    machine->state_count = definition->state_count;
+    
+    if (!FSM_CheckDepth(machine)) {
+        machine->definition = NULL;
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    machine->initial_state = FSM_FindState(machine, definition->initial_state);
+    if (!machine->initial_state) {
+        machine->definition = NULL;
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 销毁状态机
+ */
+void FSM_Destroy(FSM_Machine_t* machine)
+{
+    if (!machine) return;
+    
+    // 定时器从时间轮上摘下
+    FSM_CancelAllTimers(machine);
+    
+    // 编译态和静态状态机的存储由调用者提供
+    if (machine->definition || machine->state_pool) return;
+    
+#if !FSM_CONFIG_NO_HEAP
+    // 释放所有状态和转换
+    FSM_State_t* state = machine->states;
+    while (state) {
+        FSM_State_t* next_state = state->next;
+        
+        // 释放所有转换
+        FSM_Transition_t* transition = state->transitions;
+        while (transition) {
+            FSM_Transition_t* next_transition = transition->next;
+            free(transition);
+            transition = next_transition;
+        }
+        
+        free(state);
+        state = next_state;
+    }
+    
+    // 释放状态机
+    free(machine);
+#endif
+}
+
+/**
+ * @brief 添加状态
+ */
+FSM_Error_t FSM_AddState(
+    FSM_Machine_t* machine,
+    FSM_StateID_t id,
+    const char* name,
+    FSM_StateEnterCallback_t on_enter,
+    FSM_StateExitCallback_t on_exit,
+    FSM_StateUpdateCallback_t on_update,
+    uint32_t timeout)
+{
+    if (!machine || !name || id == 0 || machine->definition) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 检查状态是否已经存在
+    if (FSM_FindState(machine, id)) {
+        return FSM_ERR_ALREADY_REGISTERED;
+    }
+    
+    // 创建新状态
+    FSM_State_t* state = FSM_AllocState(machine);
+    if (!state) {
+        return FSM_ERR_NO_MEMORY;
+    }
+    
+    // 初始化状态
+    memset(state, 0, sizeof(FSM_State_t));
+    state->id = id;
+    strncpy(state->name, name, sizeof(state->name) - 1);
+    state->on_enter = on_enter;
+    state->on_exit = on_exit;
+    state->on_update = on_update;
+    state->timeout = timeout;
+    
+    // 添加到状态列表
+    if (!machine->states) {
+        machine->states = state;
+    } else {
+        FSM_State_t* last = machine->states;
+        while (last->next) {
+            last = last->next;
+        }
+        last->next = state;
+    }
+    
+    machine->state_count++;
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 添加状态转换规则
+ */
+FSM_Error_t FSM_AddTransition(
+    FSM_Machine_t* machine,
+    FSM_StateID_t source,
+    FSM_StateID_t target,
+    FSM_EventID_t event_id,
+    FSM_ConditionCallback_t guard,
+    FSM_ActionCallback_t action)
+{
+    if (!machine || source == 0 || target == 0 || machine->definition) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 检查源状态和目标状态是否存在
+    FSM_State_t* source_state = FSM_FindState(machine, source);
+    if (!source_state) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    
+    FSM_State_t* target_state = FSM_FindState(machine, target);
+    if (!target_state) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    
+    // 创建新转换
+    FSM_Transition_t* transition = FSM_AllocTransition(machine);
+    if (!transition) {
+        return FSM_ERR_NO_MEMORY;
+    }
+    
+    // 初始化转换
+    memset(transition, 0, sizeof(FSM_Transition_t));
+    transition->source = source;
+    transition->target = target;
+    transition->event = event_id;
+    transition->guard = guard;
+    transition->action = action;
+    
+    // 添加到转换列表
+    if (!source_state->transitions) {
+        source_state->transitions = transition;
+    } else {
+        FSM_Transition_t* last = source_state->transitions;
+        while (last->next) {
+            last = last->next;
+        }
+        last->next = transition;
+    }
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 设置父状态
+ */
+FSM_Error_t FSM_SetParent(FSM_Machine_t* machine, FSM_StateID_t state_id, FSM_StateID_t parent_id)
+{
+    if (!machine || state_id == 0 || parent_id == 0 || state_id == parent_id || machine->definition) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    FSM_State_t* state = FSM_FindState(machine, state_id);
+    FSM_State_t* parent = FSM_FindState(machine, parent_id);
+    if (!state || !parent) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    
+    if (state->parent) {
+        return state->parent == parent ? FSM_OK : FSM_ERR_ALREADY_REGISTERED;
+    }
+    
+    // 挂上后检查嵌套深度，超出（或成环）时撤销
+    state->parent = parent;
+    if (!FSM_CheckDepth(machine)) {
+        state->parent = NULL;
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 第一个子状态默认为初始子状态
+    if (!parent->initial_child) {
+        parent->initial_child = state;
+    }
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 设置父状态的初始子状态
+ */
+FSM_Error_t FSM_SetInitialChild(FSM_Machine_t* machine, FSM_StateID_t parent_id, FSM_StateID_t child_id)
+{
+    if (!machine || parent_id == 0 || child_id == 0 || machine->definition) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    FSM_State_t* parent = FSM_FindState(machine, parent_id);
+    FSM_State_t* child = FSM_FindState(machine, child_id);
+    if (!parent || !child) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    if (child->parent != parent) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    parent->initial_child = child;
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 设置父状态的历史状态类型
+ */
+FSM_Error_t FSM_SetHistory(FSM_Machine_t* machine, FSM_StateID_t state_id, FSM_History_t mode)
+{
+    if (!machine || state_id == 0 || mode > FSM_HISTORY_DEEP || machine->definition) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    FSM_State_t* state = FSM_FindState(machine, state_id);
+    if (!state) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    
+    state->history_mode = (uint8_t)mode;
+    state->history = NULL;
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 设置初始状态
+ */
+FSM_Error_t FSM_SetInitialState(FSM_Machine_t* machine, FSM_StateID_t state_id)
+{
+    if (!machine || state_id == 0) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 检查状态是否存在
+    FSM_State_t* state = FSM_FindState(machine, state_id);
+    if (!state) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    
+    // 设置初始状态
+    machine->initial_state = state;
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 启动状态机
+ */
+FSM_Error_t FSM_Start(FSM_Machine_t* machine)
+{
+    if (!machine) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 检查是否设置了初始状态
+    if (!machine->initial_state) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    
+    // 如果状态机已经启动，不执行任何操作
+    if (machine->current_state) {
+        return FSM_OK;
+    }
+    
+    // 从最外层父状态逐级进入初始状态
+    machine->in_dispatch = 1;
+    FSM_State_t* leaf = FSM_ResolveLeaf(machine->initial_state);
+    FSM_TRACE(machine, FSM_TRACE_START, NULL, leaf->id, 0, FSM_TRACE_NO_GUARD, 0);
+    FSM_Error_t result = FSM_EnterFrom(machine, leaf, NULL, NULL);
+    machine->in_dispatch = 0;
+    
+    FSM_RunToCompletion(machine);
+    
+    return result;
+}
+
+/**
+ * @brief 停止状态机
+ */
+FSM_Error_t FSM_Stop(FSM_Machine_t* machine)
+{
+    if (!machine) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 从当前状态逐级退出所有父状态
+    machine->in_dispatch = 1;
+    FSM_Error_t exit_result = FSM_ExitTo(machine, NULL, NULL);
+    machine->in_dispatch = 0;
+    
+    // 无论退出回调是否出错都停止所有定时器，不让已停止（或即将销毁）的状态机留在时间轮上
+    FSM_CancelAllTimers(machine);
+    if (exit_result != FSM_OK) {
+        return exit_result;
+    }
+    
+    FSM_TRACE(machine, FSM_TRACE_STOP, machine->current_state, 0, 0, FSM_TRACE_NO_GUARD, 0);
+    
+    // 清除当前状态
+    machine->previous_state = machine->current_state;
+    machine->current_state = NULL;
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 发送事件到状态机
+ */
+FSM_Error_t FSM_SendEvent(
+    FSM_Machine_t* machine,
+    FSM_EventID_t event_id,
+    FSM_UserData_t event_data)
+{
+    if (!machine || !machine->current_state) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    // 创建事件
+    FSM_Event_t event;
+    event.id = event_id;
+    event.data = event_data;
+    
+    // 在回调中发送的事件进入内部队列，当前事件处理完后再处理，不重入状态机
+    if (machine->in_dispatch) {
+        return FSM_QueueInternal(machine, &event, 0);
+    }
+    
+    FSM_Error_t result = FSM_Dispatch(machine, &event);
+    FSM_RunToCompletion(machine);
+    
+    return result;
+}
+
+/**
+ * @brief 投递事件到状态机的事件队列
+ */
+FSM_Error_t FSM_PostEvent(
+    FSM_Machine_t* machine,
+    FSM_EventID_t event_id,
+    FSM_UserData_t event_data)
+{
+    if (!machine || machine->group) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    FSM_Event_t event;
+    event.id = event_id;
+    event.data = event_data;
+    
+    return FSM_QueueEvent(machine, &event);
+}
+
+/**
+ * @brief 处理事件队列中的事件
+ */
+uint32_t FSM_ProcessEvents(FSM_Machine_t* machine, uint32_t budget)
+{
+    uint32_t processed = 0;
+    FSM_Event_t event;
+    
+    if (!machine || !machine->current_state || machine->in_dispatch) {
+        return 0;
+    }
+    
+    // 只靠时间轮驱动（不调用FSM_Update）时，用时间轮时间作为当前时间
+    if (fsm_wheel.started && (int32_t)(fsm_wheel.time_ms - machine->time_now) > 0) {
+        machine->time_now = fsm_wheel.time_ms;
+    }
+    
+    // 每个事件连同其回调中发送的事件一起运行到完成，都计入预算；budget为0时处理到队列为空
+    while ((budget == 0 || processed < budget) && machine->current_state && FSM_DequeueEvent(machine, &event)) {
+        FSM_Dispatch(machine, &event);
+        processed++;
+        processed += FSM_RunToCompletion(machine);
+    }
+    
+    return processed;
+}
+
+/**
+ * @brief 设置状态的延迟事件
+ */
+FSM_Error_t FSM_DeferEvent(FSM_Machine_t* machine, FSM_StateID_t state_id, FSM_EventID_t event_id)
+{
+    if (!machine || state_id == 0 || event_id >= 32U || machine->definition) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    FSM_State_t* state = FSM_FindState(machine, state_id);
+    if (!state) {
+        return FSM_ERR_STATE_NOT_FOUND;
+    }
+    
+    state->defer_mask |= 1UL << event_id;
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 启动状态机定时器
+ */
+FSM_Error_t FSM_StartTimer(
+    FSM_Machine_t* machine,
+    uint8_t timer_id,
+    FSM_EventID_t event_id,
+    uint32_t delay_ms,
+    uint32_t period_ms)
+{
+    if (!machine || machine->group || timer_id >= FSM_CONFIG_MAX_TIMERS || event_id == FSM_EVENT_STATE_TIMEOUT) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    FSM_TimerArm(machine, &machine->timers[timer_id], event_id,
+                 (FSM_UserData_t)(uintptr_t)timer_id, delay_ms, period_ms);
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 停止状态机定时器
+ */
+FSM_Error_t FSM_StopTimer(FSM_Machine_t* machine, uint8_t timer_id)
+{
+    if (!machine || timer_id >= FSM_CONFIG_MAX_TIMERS) {
+        return FSM_ERR_PARAM_INVALID;
+    }
+    
+    FSM_TimerCancel(&machine->timers[timer_id]);
+    
+    return FSM_OK;
+}
+
+/**
+ * @brief 检查定时器是否在运行
+ */
+int FSM_IsTimerActive(FSM_Machine_t* machine, uint8_t timer_id)
+{
+    if (!machine || timer_id >= FSM_CONFIG_MAX_TIMERS) {
+        return 0;
+    }
+    
+    return machine->timers[timer_id].active ? 1 : 0;
 }
 
 /**
- * @brief 执行状态转换
- * @param machine 状态机实例
- * @param transition 转换规则
- * @param event 触发事件
- * @return FSM_OK表示成功，其他表示错误
+ * @brief 推进共享时间轮
  */
-static FSM_Error_t FSM_DoTransition(
-    FSM_Machine_t* machine,
-    FSM_Transition_t* transition,
-    FSM_Event_t* event)
+void FSM_TimerTick(uint32_t time_ms)
 {
-    if (!machine || !transition) {
-        return FSM_ERR_PARAM_INVALID;
+    // 第一次调用只记录起点
+    if (!fsm_wheel.started) {
+        fsm_wheel.time_ms = time_ms;
+        fsm_wheel.started = 1;
+        return;
     }
     
-    // 找到目标状态
-    FSM_State_t* target_state = FSM_FindState(machine, transition->target);
-    if (!target_state) {
-        return FSM_ERR_STATE_NOT_FOUND;
+    uint32_t elapsed = (time_ms - fsm_wheel.time_ms) / FSM_CONFIG_WHEEL_TICK_MS;
+    if (elapsed == 0) {
+        return;
     }
+    fsm_wheel.time_ms += elapsed * FSM_CONFIG_WHEEL_TICK_MS;
     
-    // 保存当前状态作为上一个状态
-    machine->previous_state = machine->current_state;
-    
-    // 如果当前状态存在，执行退出回调
-    if (machine->current_state && machine->current_state->on_exit) {
-        FSM_Error_t exit_result = machine->current_state->on_exit(
-            machine, machine->current_state, target_state, machine->user_data);
-        if (exit_result != FSM_OK) {
-            return exit_result;
-        }
+    // 经过超过一圈时每个槽只需检查一遍
+    if (elapsed > FSM_CONFIG_WHEEL_SLOTS) {
+        fsm_wheel.tick += elapsed - FSM_CONFIG_WHEEL_SLOTS;
+        elapsed = FSM_CONFIG_WHEEL_SLOTS;
     }
     
-    // 如果转换有动作函数，执行动作
-    if (transition->action) {
-        FSM_Error_t action_result = transition->action(
-            machine, transition, event, machine->user_data);
-        if (action_result != FSM_OK) {
-            return action_result;
+    while (elapsed-- > 0) {
+        uint32_t irq_state = FSM_CRITICAL_ENTER();
+        
+        fsm_wheel.tick++;
+        FSM_Timer_t* timer = fsm_wheel.slots[fsm_wheel.tick & FSM_WHEEL_MASK];
+        while (timer) {
+            FSM_Timer_t* next = timer->next;
+            
+            // 同一槽中还有以后几圈才到期的定时器
+            if ((int32_t)(fsm_wheel.tick - timer->expire) >= 0) {
+                FSM_Event_t event;
+                event.id = timer->event;
+                event.data = timer->data;
+                
+                FSM_WheelRemove(timer);
+                
+                // 事件队列已满：单次定时器（包括状态超时）推迟一个节拍重试，不丢失到期；
+                // 周期定时器丢弃这一次，按周期等下一次
+                if (timer->machine->queue_count >= FSM_CONFIG_EVENT_QUEUE_SIZE && !timer->period) {
+                    timer->expire = fsm_wheel.tick + 1U;
+                    FSM_WheelInsert(timer);
+                    timer = next;
+                    continue;
+                }
+                FSM_QueueEvent(timer->machine, &event);
+                
+                // 周期定时器：落后超过一个周期时跳过错过的周期
+                if (timer->period) {
+                    timer->expire += timer->period;
+                    if ((int32_t)(timer->expire - fsm_wheel.tick) <= 0) {
+                        timer->expire = fsm_wheel.tick + timer->period;
+                    }
+                    FSM_WheelInsert(timer);
+                }
+            }
+            timer = next;
         }
+        
+        FSM_CRITICAL_EXIT(irq_state);
+    }
+}
+
+/**
+ * @brief 更新状态机，处理超时等
+ */
+FSM_Error_t FSM_Update(FSM_Machine_t* machine, uint32_t time_ms)
+{
+    if (!machine || !machine->current_state) {
+        return FSM_ERR_PARAM_INVALID;
     }
     
-    // 切换到目标状态
-    machine->current_state = target_state;
-    target_state->enter_time = machine->time_now;
+    // 更新当前时间
+    machine->time_now = time_ms;
     
-    // 执行进入回调
-    if (target_state->on_enter) {
-        FSM_Error_t enter_result = target_state->on_enter(
-            machine, target_state, machine->previous_state, machine->user_data);
-        if (enter_result != FSM_OK) {
-            return enter_result;
-        }
+    // 回调中发送的事件在本次更新返回前处理
+    FSM_Error_t result = FSM_OK;
+    machine->in_dispatch = 1;
+    
+    // 检查超时
+    if (machine->current_state->timeout > 0 && 
+        machine->current_state->timeout_state &&
+        time_ms - machine->enter_time >= machine->current_state->timeout) {
+        result = FSM_DoTimeout(machine);
+    } else if (machine->current_state->on_update) {
+        // 调用当前状态的更新回调
+        uint32_t start_cycles = FSM_TRACE_CYCLES();
+        FSM_State_t* state = machine->current_state;
+        result = state->on_update(machine, state, machine->user_data);
+        FSM_TRACE(machine, FSM_TRACE_UPDATE, state, state->id, 0, FSM_TRACE_NO_GUARD,
+                  FSM_TRACE_CYCLES() - start_cycles);
     }
     
-    // 增加转换计数
-    machine->transition_count++;
+    machine->in_dispatch = 0;
+    FSM_RunToCompletion(machine);
     
-    return FSM_OK;
+    return result;
 }
 
 /**
- * @brief 创建状态机
+ * @brief 把机器组实例的状态装入view
  */
-FSM_Machine_t* FSM_Create(const char* name, FSM_UserData_t user_data)
+static void FSM_GroupLoad(FSM_Group_t* group, uint16_t index)
 {
-    if (!name) return NULL;
-    
-    // 分配内存
-    FSM_Machine_t* machine = (FSM_Machine_t*)malloc(sizeof(FSM_Machine_t));
-    if (!machine) return NULL;
-    
-    // 初始化状态机
-    memset(machine, 0, sizeof(FSM_Machine_t));
-    strncpy(machine->name, name, sizeof(machine->name) - 1);
-    machine->user_data = user_data;
+    FSM_Machine_t* view = &group->view;
+    uint16_t id = group->state[index];
     
-    return machine;
+    view->current_state = id ? (FSM_State_t*)&group->definition->states[id - 1] : NULL;
+    view->previous_state = NULL;
+    view->enter_time = group->enter_time[index];
+    view->user_data = group->user_data[index];
+    view->time_now = group->time_now;
+    view->group_index = index;
 }
 
 /**
- * @brief 销毁状态机
+ * @brief 把view的状态写回机器组实例，并计算超时时刻
  */
-void FSM_Destroy(FSM_Machine_t* machine)
+static void FSM_GroupStore(FSM_Group_t* group, uint16_t index)
 {
-    if (!machine) return;
+    FSM_Machine_t* view = &group->view;
+    FSM_State_t* state = view->current_state;
     
-    // 释放所有状态和转换
-    FSM_State_t* state = machine->states;
-    while (state) {
-        FSM_State_t* next_state = state->next;
-        
-        // 释放所有转换
-        FSM_Transition_t* transition = state->transitions;
-        while (transition) {
-            FSM_Transition_t* next_transition = transition->next;
-            free(transition);
-            transition = next_transition;
-        }
-        
-        free(state);
-        state = next_state;
+    group->state[index] = state ? (uint16_t)state->id : 0U;
+    group->enter_time[index] = view->enter_time;
+    group->user_data[index] = view->user_data;  // 回调中可能调用了FSM_SetUserData
+    if (state && state->timeout > 0 && state->timeout_state) {
+        group->deadline[index] = view->enter_time + state->timeout;
+    } else {
+        group->deadline[index] = group->time_now + FSM_GROUP_NO_DEADLINE;
     }
-    
-    // 释放状态机
-    free(machine);
 }
 
 /**
- * @brief 添加状态
+ * @brief 初始化机器组
  */
-FSM_Error_t FSM_AddState(
-    FSM_Machine_t* machine,
-    FSM_StateID_t id,
+FSM_Error_t FSM_GroupInit(
+    FSM_Group_t* group,
+    const FSM_Definition_t* definition,
     const char* name,
-    FSM_StateEnterCallback_t on_enter,
-    FSM_StateExitCallback_t on_exit,
-    FSM_StateUpdateCallback_t on_update,
-    uint32_t timeout)
+    uint16_t* state,
+    uint32_t* enter_time,
+    uint32_t* deadline,
+    FSM_UserData_t* user_data,
+    uint16_t count)
 {
-    if (!machine || !name || id == 0) {
+    if (!group || !state || !enter_time || !deadline || !user_data || count == 0 ||
+        !definition || definition->state_count > 0xFFFFU) {
         return FSM_ERR_PARAM_INVALID;
     }
     
-    // 检查状态是否已经存在
-    if (FSM_FindState(machine, id)) {
-        return FSM_ERR_ALREADY_REGISTERED;
-    }
-    
-    // 创建新状态
-    FSM_State_t* state = (FSM_State_t*)malloc(sizeof(FSM_State_t));
-    if (!state) {
-        return FSM_ERR_NO_MEMORY;
+    FSM_Error_t result = FSM_InitCompiled(&group->view, definition, name, NULL);
+    if (result != FSM_OK) {
+        return result;
     }
+    group->view.group = group;
+    group->definition = definition;
+    group->state = state;
+    group->enter_time = enter_time;
+    group->deadline = deadline;
+    group->user_data = user_data;
+    group->count = count;
+    group->time_now = 0;
     
-    // 初始化状态
-    memset(state, 0, sizeof(FSM_State_t));
-    state->id = id;
-    strncpy(state->name, name, sizeof(state->name) - 1);
-    state->on_enter = on_enter;
-    state->on_exit = on_exit;
-    state->on_update = on_update;
-    state->timeout = timeout;
-    
-    // 添加到状态列表
-    if (!machine->states) {
-        machine->states = state;
-    } else {
-        FSM_State_t* last = machine->states;
-        while (last->next) {
-            last = last->next;
+    group->has_update = 0;
+    for (uint32_t i = 0; i < definition->state_count; i++) {
+        if (definition->states[i].on_update) {
+            group->has_update = 1;
         }
-        last->next = state;
     }
     
-    machine->state_count++;
+    for (uint16_t i = 0; i < count; i++) {
+        state[i] = 0;
+        enter_time[i] = 0;
+        deadline[i] = FSM_GROUP_NO_DEADLINE;
+        user_data[i] = NULL;
+    }
     
     return FSM_OK;
 }
 
 /**
- * @brief 添加状态转换规则
+ * @brief 设置机器组实例的用户数据
  */
-FSM_Error_t FSM_AddTransition(
-    FSM_Machine_t* machine,
-    FSM_StateID_t source,
-    FSM_StateID_t target,
-    FSM_EventID_t event_id,
-    FSM_ConditionCallback_t guard,
-    FSM_ActionCallback_t action)
+FSM_Error_t FSM_GroupSetUserData(FSM_Group_t* group, uint16_t index, FSM_UserData_t user_data)
 {
-    if (!machine || source == 0 || target == 0) {
+    if (!group || index >= group->count) {
         return FSM_ERR_PARAM_INVALID;
     }
     
-    // 检查源状态和目标状态是否存在
-    FSM_State_t* source_state = FSM_FindState(machine, source);
-    if (!source_state) {
-        return FSM_ERR_STATE_NOT_FOUND;
-    }
+    group->user_data[index] = user_data;
     
-    FSM_State_t* target_state = FSM_FindState(machine, target);
-    if (!target_state) {
-        return FSM_ERR_STATE_NOT_FOUND;
-    }
+    return FSM_OK;
+}
+
+/**
+ * @brief 启动机器组的所有实例
+ */
+FSM_Error_t FSM_GroupStart(FSM_Group_t* group, uint32_t time_ms)
+{
+    FSM_Error_t first_error = FSM_OK;
     
-    // 创建新转换
-    FSM_Transition_t* transition = (FSM_Transition_t*)malloc(sizeof(FSM_Transition_t));
-    if (!transition) {
-        return FSM_ERR_NO_MEMORY;
+    if (!group || group->view.in_dispatch) {
+        return FSM_ERR_PARAM_INVALID;
     }
     
-    // 初始化转换
-    memset(transition, 0, sizeof(FSM_Transition_t));
-    transition->source = source;
-    transition->target = target;
-    transition->event = event_id;
-    transition->guard = guard;
-    transition->action = action;
-    
-    // 添加到转换列表
-    if (!source_state->transitions) {
-        source_state->transitions = transition;
-    } else {
-        FSM_Transition_t* last = source_state->transitions;
-        while (last->next) {
-            last = last->next;
+    group->time_now = time_ms;
+    for (uint16_t i = 0; i < group->count; i++) {
+        if (group->state[i] != 0) {
+            continue;
+        }
+        FSM_GroupLoad(group, i);
+        FSM_Error_t result = FSM_Start(&group->view);
+        FSM_GroupStore(group, i);
+        if (result != FSM_OK && first_error == FSM_OK) {
+            first_error = result;
         }
-        last->next = transition;
     }
     
-    return FSM_OK;
+    return first_error;
 }
 
 /**
- * @brief 设置初始状态
+ * @brief 向机器组的一个实例发送事件
  */
-FSM_Error_t FSM_SetInitialState(FSM_Machine_t* machine, FSM_StateID_t state_id)
+FSM_Error_t FSM_GroupSendEvent(
+    FSM_Group_t* group,
+    uint16_t index,
+    FSM_EventID_t event_id,
+    FSM_UserData_t event_data)
 {
-    if (!machine || state_id == 0) {
+    if (!group || index >= group->count || group->state[index] == 0) {
         return FSM_ERR_PARAM_INVALID;
     }
     
-    // 检查状态是否存在
-    FSM_State_t* state = FSM_FindState(machine, state_id);
-    if (!state) {
-        return FSM_ERR_STATE_NOT_FOUND;
+    // view正装着另一个实例（在本组的回调中调用）
+    if (group->view.in_dispatch) {
+        return FSM_ERR_STATE_ACTIVE;
     }
     
-    // 设置初始状态
-    machine->initial_state = state;
+    FSM_GroupLoad(group, index);
+    FSM_Error_t result = FSM_SendEvent(&group->view, event_id, event_data);
+    FSM_GroupStore(group, index);
     
-    return FSM_OK;
+    return result;
 }
 
 /**
- * @brief 启动状态机
+ * @brief 执行机器组实例的超时转换
+ * @return 1表示执行了超时转换，0表示该状态没有超时（只刷新截止时间）
  */
-FSM_Error_t FSM_Start(FSM_Machine_t* machine)
+static uint32_t FSM_GroupExpire(FSM_Group_t* group, uint16_t index)
 {
-    if (!machine) {
-        return FSM_ERR_PARAM_INVALID;
-    }
+    uint16_t id = group->state[index];
+    const FSM_State_t* state = id ? &group->definition->states[id - 1] : NULL;
     
-    // 检查是否设置了初始状态
-    if (!machine->initial_state) {
-        return FSM_ERR_STATE_NOT_FOUND;
+    if (!state || state->timeout == 0 || !state->timeout_state) {
+        group->deadline[index] = group->time_now + FSM_GROUP_NO_DEADLINE;
+        return 0;
     }
     
-    // 如果状态机已经启动，不执行任何操作
-    if (machine->current_state) {
-        return FSM_OK;
+    FSM_GroupLoad(group, index);
+    group->view.in_dispatch = 1;
+    FSM_DoTimeout(&group->view);
+    group->view.in_dispatch = 0;
+    FSM_RunToCompletion(&group->view);
+    FSM_GroupStore(group, index);
+    
+    return 1;
+}
+
+/**
+ * @brief 更新机器组
+ */
+uint32_t FSM_GroupUpdate(FSM_Group_t* group, uint32_t time_ms)
+{
+    uint32_t expired = 0;
+    
+    if (!group || group->view.in_dispatch) {
+        return 0;
     }
     
-    // 设置当前状态为初始状态
-    machine->current_state = machine->initial_state;
-    machine->initial_state->enter_time = machine->time_now;
+    group->time_now = time_ms;
     
-    // 执行进入回调
-    if (machine->initial_state->on_enter) {
-        return machine->initial_state->on_enter(
-            machine, machine->initial_state, NULL, machine->user_data);
+    // 超时扫描：只读超时时刻数组，到期的实例才访问状态表
+    const uint32_t* deadline = group->deadline;
+    for (uint16_t i = 0; i < group->count; i++) {
+        if ((int32_t)(time_ms - deadline[i]) >= 0) {
+            expired += FSM_GroupExpire(group, i);
+        }
     }
     
-    return FSM_OK;
+    // 更新回调
+    if (group->has_update) {
+        for (uint16_t i = 0; i < group->count; i++) {
+            uint16_t id = group->state[i];
+            if (id == 0 || !group->definition->states[id - 1].on_update) {
+                continue;
+            }
+            
+            FSM_GroupLoad(group, i);
+            FSM_State_t* state = group->view.current_state;
+            group->view.in_dispatch = 1;
+            state->on_update(&group->view, state, group->view.user_data);
+            group->view.in_dispatch = 0;
+            FSM_RunToCompletion(&group->view);
+            FSM_GroupStore(group, i);
+        }
+    }
+    
+    return expired;
 }
 
 /**
- * @brief 停止状态机
+ * @brief 获取机器组实例的当前状态ID
  */
-FSM_Error_t FSM_Stop(FSM_Machine_t* machine)
+FSM_StateID_t FSM_GroupGetState(FSM_Group_t* group, uint16_t index)
 {
-    if (!machine) {
-        return FSM_ERR_PARAM_INVALID;
+    if (!group || index >= group->count) {
+        return 0;
     }
     
-    // 如果当前状态存在，执行退出回调
-    if (machine->current_state && machine->current_state->on_exit) {
-        FSM_Error_t exit_result = machine->current_state->on_exit(
-            machine, machine->current_state, NULL, machine->user_data);
-        if (exit_result != FSM_OK) {
-            return exit_result;
-        }
+    return group->state[index];
+}
+
+/**
+ * @brief 在机器组的回调中获取正在处理的实例序号
+ */
+uint16_t FSM_GroupGetIndex(FSM_Machine_t* machine)
+{
+    if (!machine || !machine->group) {
+        return 0xFFFFU;
     }
     
-    // 清除当前状态
-    machine->previous_state = machine->current_state;
-    machine->current_state = NULL;
-    
-    return FSM_OK;
+    return machine->group_index;
 }
 
 /**
- * @brief 发送事件到状态机
+ * @brief 为状态机挂上跟踪缓冲区
  */
-FSM_Error_t FSM_SendEvent(
-    FSM_Machine_t* machine,
-    FSM_EventID_t event_id,
-    FSM_UserData_t event_data)
+FSM_Error_t FSM_TraceAttach(FSM_Machine_t* machine, FSM_Trace_t* trace)
 {
-    if (!machine || !machine->current_state) {
+#if FSM_CONFIG_TRACE
+    if (!machine) {
         return FSM_ERR_PARAM_INVALID;
     }
     
-    // 创建事件
-    FSM_Event_t event;
-    event.id = event_id;
-    event.data = event_data;
-    
-    // 查找匹配的转换
-    FSM_Transition_t* transition = machine->current_state->transitions;
-    while (transition) {
-        // 检查事件是否匹配
-        if (transition->event == event_id) {
-            // 检查条件是否满足
-            if (!transition->guard || transition->guard(machine, transition, &event, machine->user_data)) {
-                // 执行转换
-                return FSM_DoTransition(machine, transition, &event);
-            }
-        }
-        transition = transition->next;
+    if (trace) {
+        memset(trace, 0, sizeof(FSM_Trace_t));
     }
+    machine->trace = trace;
     
-    // 没有匹配的转换
-    return FSM_ERR_EVENT_NOT_HANDLED;
+    return FSM_OK;
+#else
+    (void)machine;
+    (void)trace;
+    return FSM_ERR_PARAM_INVALID;
+#endif
 }
 
 /**
- * @brief 更新状态机，处理超时等
+ * @brief 导出跟踪缓冲区
  */
-FSM_Error_t FSM_Update(FSM_Machine_t* machine, uint32_t time_ms)
+void FSM_TraceDump(FSM_Machine_t* machine)
 {
-    if (!machine || !machine->current_state) {
-        return FSM_ERR_PARAM_INVALID;
-    }
+#if FSM_CONFIG_TRACE
+    if (!machine || !machine->trace) return;
     
-    // 更新当前时间
-    machine->time_now = time_ms;
+    const FSM_Trace_t* trace = machine->trace;
+    uint32_t head = trace->head;
+    uint32_t count = head < FSM_CONFIG_TRACE_SIZE ? head : FSM_CONFIG_TRACE_SIZE;
     
-    // 检查超时
-    if (machine->current_state->timeout > 0 && 
-        machine->current_state->timeout_state &&
-        time_ms - machine->current_state->enter_time >= machine->current_state->timeout) {
-        
-        // 创建超时转换
-        FSM_Transition_t timeout_transition;
-        memset(&timeout_transition, 0, sizeof(FSM_Transition_t));
-        timeout_transition.source = machine->current_state->id;
-        timeout_transition.target = machine->current_state->timeout_state->id;
-        
-        // 创建空事件
-        FSM_Event_t timeout_event;
-        memset(&timeout_event, 0, sizeof(FSM_Event_t));
-        
-        // 执行超时转换
-        return FSM_DoTransition(machine, &timeout_transition, &timeout_event);
+    FSM_PRINTF("FSM-TRACE-BEGIN %lu %lu %s\r\n", (unsigned long)head,
+               (unsigned long)FSM_CONFIG_TRACE_SIZE, machine->name);
+    
+    // 状态名称表，解码器据此显示名称
+    if (machine->definition) {
+        for (uint32_t i = 0; i < machine->definition->state_count; i++) {
+            const FSM_State_t* state = &machine->definition->states[i];
+            FSM_PRINTF("S %lu %s\r\n", (unsigned long)state->id, state->name);
+        }
+    } else {
+        for (const FSM_State_t* state = machine->states; state; state = state->next) {
+            FSM_PRINTF("S %lu %s\r\n", (unsigned long)state->id, state->name);
+        }
     }
     
-    // 调用当前状态的更新回调
-    if (machine->current_state->on_update) {
-        return machine->current_state->on_update(
-            machine, machine->current_state, machine->user_data);
+    // 从最旧的记录开始输出
+    for (uint32_t n = head - count; n != head; n++) {
+        const FSM_TraceRecord_t* r = &trace->records[n & (FSM_CONFIG_TRACE_SIZE - 1U)];
+        FSM_PRINTF("R %lx %lx %x %x %x %x %x\r\n", (unsigned long)r->timestamp, (unsigned long)r->cycles,
+                   r->kind, r->from, r->to, r->event, r->guard);
     }
     
-    return FSM_OK;
+    FSM_PRINTF("FSM-TRACE-END\r\n");
+#else
+    (void)machine;
+#endif
+}
+
+/**
+ * @brief 设置跟踪使用的周期计数器
+ */
+void FSM_SetCycleCounter(FSM_CycleCounter_t counter)
+{
+#if FSM_CONFIG_TRACE
+    fsm_cycle_counter = counter;
+#else
+    (void)counter;
+#endif
 }
 
 /**
@@ -455,7 +1689,14 @@ int FSM_IsInState(FSM_Machine_t* machine, FSM_StateID_t state_id)
         return 0;
     }
     
-    return machine->current_state->id == state_id ? 1 : 0;
+    // 处于子状态时也处于其所有父状态
+    for (FSM_State_t* state = machine->current_state; state; state = state->parent) {
+        if (state->id == state_id) {
+            return 1;
+        }
+    }
+    
+    return 0;
 }
 
 /**
@@ -467,7 +1708,7 @@ uint32_t FSM_GetStateTime(FSM_Machine_t* machine)
         return 0;
     }
     
-    return machine->time_now - machine->current_state->enter_time;
+    return machine->time_now - machine->enter_time;
 }
 
 /**
@@ -478,7 +1719,7 @@ FSM_Error_t FSM_SetTimeoutState(
     FSM_StateID_t state_id,
     FSM_StateID_t timeout_state_id)
 {
-    if (!machine || state_id == 0 || timeout_state_id == 0) {
+    if (!machine || state_id == 0 || timeout_state_id == 0 || machine->definition) {
         return FSM_ERR_PARAM_INVALID;
     }
     
@@ -13,6 +13,13 @@
  * - 支持异步状态转换
  * - 支持状态超时处理
  * - 支持状态历史记录
+ * - 支持编译态常量表定义（O(1)分派，可放在Flash中，不使用堆）
+ * - 支持层次状态机（父状态、事件冒泡、历史状态）
+ * - 支持运行到完成的事件队列、中断中投递事件和延迟事件
+ * - 支持基于共享时间轮的多定时器
+ * - 支持静态存储：状态机、状态和转换位于一块调用者提供的静态内存中，可完全不使用堆
+ * - 支持机器组：大量相同的状态机共享一个编译态定义，实例状态按数组存放，一次扫描处理全部超时
+ * - 支持转换跟踪环形缓冲区（条件结果、回调耗时），可事后导出并在主机端解码
  */
 
 #ifndef __FSM_H
@@ -26,6 +33,95 @@
 extern "C" {
 #endif
 
+/* 层次状态机的最大嵌套深度（顶层状态深度为0） */
+#ifndef FSM_CONFIG_MAX_DEPTH
+#define FSM_CONFIG_MAX_DEPTH    4
+#endif
+
+/* 每个状态机的待处理事件队列长度 */
+#ifndef FSM_CONFIG_EVENT_QUEUE_SIZE
+#define FSM_CONFIG_EVENT_QUEUE_SIZE     8
+#endif
+
+/* 每个状态机的延迟事件队列长度 */
+#ifndef FSM_CONFIG_DEFER_QUEUE_SIZE
+#define FSM_CONFIG_DEFER_QUEUE_SIZE     4
+#endif
+
+/* 每个状态机的内部事件队列长度（回调中发送的事件和放回的延迟事件，与中断投递的事件分开） */
+#ifndef FSM_CONFIG_INTERNAL_QUEUE_SIZE
+#define FSM_CONFIG_INTERNAL_QUEUE_SIZE  8
+#endif
+
+#if (FSM_CONFIG_EVENT_QUEUE_SIZE < 1) || (FSM_CONFIG_EVENT_QUEUE_SIZE > 255) || \
+    (FSM_CONFIG_DEFER_QUEUE_SIZE < 1) || (FSM_CONFIG_DEFER_QUEUE_SIZE > 255) || \
+    (FSM_CONFIG_INTERNAL_QUEUE_SIZE < 1) || (FSM_CONFIG_INTERNAL_QUEUE_SIZE > 255)
+#error "FSM_CONFIG_EVENT_QUEUE_SIZE/FSM_CONFIG_DEFER_QUEUE_SIZE/FSM_CONFIG_INTERNAL_QUEUE_SIZE must be 1..255"
+#endif
+
+/* 每个状态机的定时器数量（另有一个内部定时器用于状态超时） */
+#ifndef FSM_CONFIG_MAX_TIMERS
+#define FSM_CONFIG_MAX_TIMERS           4
+#endif
+
+/* 时间轮槽数（2的幂） */
+#ifndef FSM_CONFIG_WHEEL_SLOTS
+#define FSM_CONFIG_WHEEL_SLOTS          32
+#endif
+
+/* 时间轮节拍(ms)，即定时器精度 */
+#ifndef FSM_CONFIG_WHEEL_TICK_MS
+#define FSM_CONFIG_WHEEL_TICK_MS        10
+#endif
+
+#if (FSM_CONFIG_WHEEL_SLOTS & (FSM_CONFIG_WHEEL_SLOTS - 1)) != 0
+#error "FSM_CONFIG_WHEEL_SLOTS must be a power of two"
+#endif
+
+/* 禁止使用堆（1:不提供FSM_Create，状态机只能用FSM_CreateStatic或FSM_InitCompiled创建） */
+#ifndef FSM_CONFIG_NO_HEAP
+#define FSM_CONFIG_NO_HEAP              0
+#endif
+
+/* 转换跟踪（1:启用，见FSM_TraceAttach） */
+#ifndef FSM_CONFIG_TRACE
+#define FSM_CONFIG_TRACE                0
+#endif
+
+/* 跟踪环形缓冲区记录数（2的幂） */
+#ifndef FSM_CONFIG_TRACE_SIZE
+#define FSM_CONFIG_TRACE_SIZE           64
+#endif
+
+#if (FSM_CONFIG_TRACE_SIZE & (FSM_CONFIG_TRACE_SIZE - 1)) != 0
+#error "FSM_CONFIG_TRACE_SIZE must be a power of two"
+#endif
+
+/* 跟踪导出的输出函数 */
+#ifndef FSM_PRINTF
+#define FSM_PRINTF                      printf
+#endif
+
+/* 状态超时事件（内部使用，由时间轮投递） */
+#define FSM_EVENT_STATE_TIMEOUT         0xFFFFFFFFUL
+
+/* 临界区保护（中断投递事件与主循环取事件共享事件队列、时间轮），主机构建时为空操作 */
+#ifndef FSM_CRITICAL_ENTER
+#if defined(__arm__) || defined(__ARMCC_VERSION) || defined(__ICCARM__)
+#include "main.h"
+static inline uint32_t FSM_Port_IrqSave(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+#define FSM_CRITICAL_ENTER()        FSM_Port_IrqSave()
+#define FSM_CRITICAL_EXIT(state)    __set_PRIMASK(state)
+#else
+#define FSM_CRITICAL_ENTER()        0U
+#define FSM_CRITICAL_EXIT(state)    ((void)(state))
+#endif
+#endif
+
 /**
  * @brief FSM错误码定义
  */
@@ -39,9 +135,19 @@ typedef enum {
     FSM_ERR_STATE_ACTIVE,        ///< 状态处于活动状态
     FSM_ERR_EVENT_NOT_HANDLED,   ///< 事件未处理
     FSM_ERR_TIMEOUT,             ///< 超时错误
+    FSM_ERR_QUEUE_FULL,          ///< 事件队列已满
     FSM_ERR_UNKNOWN              ///< 未知错误
 } FSM_Error_t;
 
+/**
+ * @brief 历史状态类型
+ */
+typedef enum {
+    FSM_HISTORY_NONE = 0,        ///< 无历史：每次进入父状态都进入其初始子状态
+    FSM_HISTORY_SHALLOW,         ///< 浅历史：恢复上次离开时的直接子状态
+    FSM_HISTORY_DEEP             ///< 深历史：恢复上次离开时的叶子状态
+} FSM_History_t;
+
 /**
  * @brief FSM状态ID类型
  */
@@ -62,6 +168,76 @@ struct FSM_Machine;
 struct FSM_State;
 struct FSM_Transition;
 struct FSM_Event;
+struct FSM_Definition;
+struct FSM_Group;
+
+/**
+ * @brief 事件定义
+ */
+typedef struct FSM_Event {
+    FSM_EventID_t id;                  ///< 事件ID
+    FSM_UserData_t data;               ///< 事件数据
+} FSM_Event_t;
+
+/**
+ * @brief 状态机定时器，挂在共享时间轮上，到期时向所属状态机投递事件
+ */
+typedef struct FSM_Timer {
+    struct FSM_Timer *next;            ///< 同一时间轮槽中的下一个定时器
+    struct FSM_Timer *prev;            ///< 同一时间轮槽中的上一个定时器
+    struct FSM_Machine *machine;       ///< 所属状态机
+    FSM_EventID_t event;               ///< 到期时投递的事件
+    FSM_UserData_t data;               ///< 到期事件的数据（用户定时器为定时器ID）
+    uint32_t expire;                   ///< 到期的时间轮节拍
+    uint32_t period;                   ///< 周期（节拍），0表示单次
+    uint8_t active;                    ///< 是否在时间轮上
+} FSM_Timer_t;
+
+/**
+ * @brief 跟踪记录类型
+ */
+typedef enum {
+    FSM_TRACE_START = 0,         ///< 启动，to为初始叶子状态
+    FSM_TRACE_TRANSITION,        ///< 转换完成，cycles为退出、动作、进入回调的总耗时
+    FSM_TRACE_GUARD,             ///< 条件函数调用，guard为结果，to为该转换的目标，cycles为条件函数耗时
+    FSM_TRACE_UNHANDLED,         ///< 当前状态及其父状态都不处理该事件
+    FSM_TRACE_DEFERRED,          ///< 事件被延迟
+    FSM_TRACE_UPDATE,            ///< on_update调用，cycles为其耗时
+    FSM_TRACE_ERROR,             ///< 转换中回调返回错误，guard为错误码
+    FSM_TRACE_STOP               ///< 停止，from为停止前的叶子状态
+} FSM_TraceKind_t;
+
+/* 跟踪记录中的超时事件ID（FSM_EVENT_STATE_TIMEOUT截断为16位） */
+#define FSM_TRACE_EVENT_TIMEOUT         0xFFFFU
+
+/* 跟踪记录中转换没有条件函数时的guard值 */
+#define FSM_TRACE_NO_GUARD              0xFFU
+
+/**
+ * @brief 跟踪记录（16字节），状态ID和事件ID只保留低16位
+ */
+typedef struct FSM_TraceRecord {
+    uint32_t timestamp;                ///< 状态机当前时间(ms)
+    uint32_t cycles;                   ///< 回调耗时（周期计数器差值）
+    uint16_t from;                     ///< 源叶子状态ID
+    uint16_t to;                       ///< 目标状态ID
+    uint16_t event;                    ///< 事件ID
+    uint8_t kind;                      ///< 记录类型（FSM_TraceKind_t）
+    uint8_t guard;                     ///< 条件结果：1满足，0不满足，FSM_TRACE_NO_GUARD无条件
+} FSM_TraceRecord_t;
+
+/**
+ * @brief 跟踪环形缓冲区，由调用者提供存储，写满后覆盖最旧的记录
+ */
+typedef struct FSM_Trace {
+    uint32_t head;                     ///< 已写入的记录总数
+    FSM_TraceRecord_t records[FSM_CONFIG_TRACE_SIZE]; ///< 记录，第head % FSM_CONFIG_TRACE_SIZE项为下一次写入位置
+} FSM_Trace_t;
+
+/**
+ * @brief 周期计数器读取函数类型（返回自由运行的32位计数值，如DWT->CYCCNT）
+ */
+typedef uint32_t (*FSM_CycleCounter_t)(void);
 
 /**
  * @brief 状态机实例的结构体
@@ -75,7 +251,31 @@ typedef struct FSM_Machine {
     struct FSM_State *initial_state; ///< 初始状态
     FSM_UserData_t user_data;        ///< 用户数据
     uint32_t time_now;               ///< 当前时间
+    uint32_t enter_time;             ///< 进入当前状态的时间
     uint32_t transition_count;       ///< 状态转换计数
+    const struct FSM_Definition *definition; ///< 编译态定义，NULL表示动态构建的状态机
+    struct FSM_State *state_pool;    ///< 静态状态池，NULL表示状态和转换从堆分配
+    struct FSM_Transition *transition_pool; ///< 静态转换池
+    uint16_t state_capacity;         ///< 状态池容量
+    uint16_t transition_capacity;    ///< 转换池容量
+    uint16_t transition_used;        ///< 转换池已用数量
+    struct FSM_Group *group;         ///< 所属机器组，NULL表示独立状态机
+    uint16_t group_index;            ///< 机器组中正在处理的实例序号
+    FSM_Event_t event_queue[FSM_CONFIG_EVENT_QUEUE_SIZE]; ///< 待处理事件队列（环形）
+    FSM_Event_t defer_queue[FSM_CONFIG_DEFER_QUEUE_SIZE]; ///< 延迟事件队列
+    FSM_Event_t internal_queue[FSM_CONFIG_INTERNAL_QUEUE_SIZE]; ///< 内部事件队列（环形，须在本次调用返回前处理）
+    volatile uint8_t queue_head;     ///< 待处理事件队列头
+    volatile uint8_t queue_count;    ///< 待处理事件数
+    uint8_t defer_count;             ///< 延迟事件数
+    uint8_t in_dispatch;             ///< 正在处理事件（回调中发送的事件进入内部队列，运行到完成）
+    uint8_t internal_head;           ///< 内部事件队列头
+    uint8_t internal_count;          ///< 内部事件数
+    volatile uint32_t event_drops;   ///< 队列满丢弃的事件数
+    FSM_Timer_t timers[FSM_CONFIG_MAX_TIMERS + 1]; ///< 用户定时器，最后一个用于状态超时
+    uint32_t timeout_seq;            ///< 状态进入序号，用于识别过期的状态超时事件
+#if FSM_CONFIG_TRACE
+    FSM_Trace_t *trace;              ///< 跟踪缓冲区，NULL表示不跟踪
+#endif
 } FSM_Machine_t;
 
 /**
@@ -96,7 +296,7 @@ typedef FSM_Error_t (*FSM_StateEnterCallback_t)(
  * @brief 状态退出回调函数类型
  * @param machine 状态机实例
  * @param state 当前状态
- * @param next_state 下一个状态
+ * @param next_state 转换的目标状态（目标为父状态时是该父状态，而不是随后进入的子状态）
  * @param user_data 用户数据
  * @return FSM_OK表示成功，其他表示错误
  */
@@ -172,27 +372,217 @@ typedef struct FSM_State {
     struct FSM_State *timeout_state;   ///< 超时后转到的状态
     uint32_t enter_time;               ///< 进入该状态的时间
     struct FSM_State *next;            ///< 下一个状态
+    struct FSM_State *parent;          ///< 父状态，NULL表示顶层状态
+    struct FSM_State *initial_child;   ///< 初始子状态，NULL表示叶子状态
+    struct FSM_State *history;         ///< 上次离开时的子状态（历史状态）
+    uint8_t history_mode;              ///< 历史状态类型（FSM_History_t）
+    uint32_t defer_mask;               ///< 延迟事件位图（第n位对应事件ID n，仅支持ID 0~31）
 } FSM_State_t;
 
 /**
- * @brief 事件定义
+ * @brief 编译态状态机定义
+ * @details 状态和转换全部是常量表，可放在Flash中，运行时不使用堆：
+ *          - 状态ID须为1..state_count，且states[i].id == i + 1
+ *          - 事件ID须为0..event_count-1
+ *          - table为state_count行、event_count列的转换表，table[源状态ID-1][事件ID]即该转换，
+ *            target为0的单元表示不处理该事件
+ *          - 同一状态同一事件有多条带条件的转换时，用next链接候选转换，按顺序检查条件
+ *          分派事件只需一次查表，查找状态只需一次下标运算。
+ */
+typedef struct FSM_Definition {
+    const FSM_State_t *states;         ///< 状态表
+    const FSM_Transition_t *table;     ///< 转换表（state_count * event_count）
+    uint32_t state_count;              ///< 状态数量
+    uint32_t event_count;              ///< 事件数量
+    FSM_StateID_t initial_state;       ///< 初始状态ID
+} FSM_Definition_t;
+
+/* 机器组实例当前状态没有超时时的截止时间间隔（到期后只刷新，不转换） */
+#define FSM_GROUP_NO_DEADLINE           0x7FFFFFFFUL
+
+/**
+ * @brief 机器组：多个相同的状态机共享一个编译态定义
+ * @details 每个实例只保存当前状态ID、进入时间、超时时刻和用户数据，按数组（结构体数组的转置）存放，
+ *          FSM_GroupUpdate只需顺序扫描超时时刻数组。处理某个实例时把它的状态装入view，
+ *          复用单个状态机的全部逻辑，回调收到的machine即view，user_data为该实例的用户数据。
+ */
+typedef struct FSM_Group {
+    FSM_Machine_t view;                ///< 处理单个实例时使用的状态机
+    const struct FSM_Definition *definition; ///< 共享的编译态定义
+    uint16_t *state;                   ///< 各实例当前叶子状态ID，0表示未启动
+    uint32_t *enter_time;              ///< 各实例进入当前状态的时间
+    uint32_t *deadline;                ///< 各实例当前状态的超时时刻
+    FSM_UserData_t *user_data;         ///< 各实例的用户数据
+    uint16_t count;                    ///< 实例数量
+    uint8_t has_update;                ///< 定义中是否有状态带on_update
+    uint32_t time_now;                 ///< 当前时间
+} FSM_Group_t;
+
+/**
+ * @brief 定义机器组的静态存储块（组和各实例的状态数组在同一块静态内存中）
+ * @param var 存储块变量名
+ * @param instance_count 实例数量
+ */
+#define FSM_GROUP_STORAGE(var, instance_count) \
+    struct { \
+        FSM_Group_t group; \
+        uint16_t state[instance_count]; \
+        uint32_t enter_time[instance_count]; \
+        uint32_t deadline[instance_count]; \
+        FSM_UserData_t user_data[instance_count]; \
+    } var
+
+/**
+ * @brief 用FSM_GROUP_STORAGE定义的存储块初始化机器组
+ * @param var 存储块变量名
+ * @param definition 编译态定义
+ * @param name 机器组名称
+ */
+#define FSM_GROUP_INIT(var, definition, name) \
+    FSM_GroupInit(&(var).group, (definition), (name), (var).state, (var).enter_time, (var).deadline, \
+                  (var).user_data, sizeof((var).state) / sizeof((var).state[0]))
+
+/**
+ * @brief 编译态状态表项
+ * @param id 状态ID（与表中位置对应：第i项的ID为i + 1）
+ * @param name 状态名称
+ * @param on_enter 进入状态回调
+ * @param on_exit 退出状态回调
+ * @param on_update 状态更新回调
+ * @param timeout 状态超时时间(ms)，0表示不超时
+ * @param timeout_state 超时后转到的状态，用FSM_STATE_REF()引用，NULL表示无
  */
-typedef struct FSM_Event {
-    FSM_EventID_t id;                  ///< 事件ID
-    FSM_UserData_t data;               ///< 事件数据
-} FSM_Event_t;
+#define FSM_STATE_DEF(id, name, on_enter, on_exit, on_update, timeout, timeout_state) \
+    { (id), name, (on_enter), (on_exit), (on_update), NULL, (timeout), (timeout_state), 0, NULL, \
+      NULL, NULL, NULL, FSM_HISTORY_NONE, 0 }
+
+/**
+ * @brief 编译态层次状态表项
+ * @param parent 父状态，用FSM_STATE_REF()引用，NULL表示顶层状态
+ * @param initial_child 初始子状态，用FSM_STATE_REF()引用，NULL表示叶子状态
+ * @note 其余参数同FSM_STATE_DEF；状态表是只读的，编译态状态机不支持历史状态
+ */
+#define FSM_HSTATE_DEF(id, name, on_enter, on_exit, on_update, timeout, timeout_state, parent, initial_child) \
+    { (id), name, (on_enter), (on_exit), (on_update), NULL, (timeout), (timeout_state), 0, NULL, \
+      (parent), (initial_child), NULL, FSM_HISTORY_NONE, 0 }
+
+/**
+ * @brief 编译期检查，条件不成立时数组长度为负而编译报错；值恒为0，可用在常量表达式中
+ */
+#define FSM_STATIC_CHECK(condition) (0U * sizeof(char[(condition) ? 1 : -1]))
+
+/**
+ * @brief 引用编译态状态表中的状态（用于FSM_STATE_DEF的timeout_state）
+ */
+#define FSM_STATE_REF(states, id) ((FSM_State_t*)&(states)[(id) - 1])
+
+/**
+ * @brief 单条编译态转换，alternative为条件不满足时检查的候选转换（地址），NULL表示无
+ */
+#define FSM_TRANSITION_DEF(source, target, event_id, guard, action, alternative) \
+    { (source), (target), (event_id), (guard), (action), (FSM_Transition_t*)(alternative) }
+
+/**
+ * @brief 转换表单元：源状态source收到事件event_id时转到target
+ */
+#define FSM_ON(source, target, event_id, guard, action) \
+    [(source) - 1][(event_id)] = FSM_TRANSITION_DEF(source, target, event_id, guard, action, NULL)
 
+/**
+ * @brief 带候选的转换表单元：guard不满足时继续检查alternative（FSM_TRANSITION_DEF定义的常量）
+ */
+#define FSM_ON_ELSE(source, target, event_id, guard, action, alternative) \
+    [(source) - 1][(event_id)] = FSM_TRANSITION_DEF(source, target, event_id, guard, action, &(alternative))
+
+/**
+ * @brief 由状态表和二维转换表生成编译态定义
+ * @param states 状态表数组
+ * @param table 转换表二维数组 [状态数][事件数]，行数必须等于状态表项数（否则编译报错）
+ * @param initial_state 初始状态ID
+ */
+#define FSM_DEFINITION(states, table, initial_state) \
+    { (states), &(table)[0][0], \
+      sizeof(states) / sizeof((states)[0]) + \
+          FSM_STATIC_CHECK(sizeof(table) / sizeof((table)[0]) == sizeof(states) / sizeof((states)[0])), \
+      sizeof((table)[0]) / sizeof((table)[0][0]), (initial_state) }
+
+/**
+ * @brief 定义一个状态机的静态存储块：状态机、状态池和转换池位于同一块静态内存中
+ * @param var 存储块变量名
+ * @param max_states 最大状态数
+ * @param max_transitions 最大转换数
+ * @note 用法：static FSM_STATIC_STORAGE(app_fsm_storage, 10, 20); 占用sizeof(app_fsm_storage)字节，链接时确定
+ */
+#define FSM_STATIC_STORAGE(var, max_states, max_transitions) \
+    struct { \
+        FSM_Machine_t machine; \
+        FSM_State_t states[max_states]; \
+        FSM_Transition_t transitions[max_transitions]; \
+    } var
+
+/**
+ * @brief 在FSM_STATIC_STORAGE定义的存储块中创建状态机
+ * @param var 存储块变量名
+ * @param name 状态机名称
+ * @param user_data 用户数据
+ */
+#define FSM_CREATE_STATIC(var, name, user_data) \
+    FSM_CreateStatic(&(var).machine, (var).states, sizeof((var).states) / sizeof((var).states[0]), \
+                     (var).transitions, sizeof((var).transitions) / sizeof((var).transitions[0]), \
+                     (name), (user_data))
+
+#if !FSM_CONFIG_NO_HEAP
 /**
  * @brief 创建状态机
  * @param name 状态机名称
  * @param user_data 用户数据
  * @return 状态机实例指针，NULL表示创建失败
+ * @note 状态机、每个状态和每条转换分别从堆分配；定义FSM_CONFIG_NO_HEAP为1时不提供
  */
 FSM_Machine_t* FSM_Create(const char* name, FSM_UserData_t user_data);
+#endif
+
+/**
+ * @brief 在调用者提供的存储中创建状态机（不使用堆）
+ * @param machine 状态机存储
+ * @param states 状态池
+ * @param max_states 状态池容量
+ * @param transitions 转换池，max_transitions为0时可为NULL
+ * @param max_transitions 转换池容量
+ * @param name 状态机名称
+ * @param user_data 用户数据
+ * @return 状态机实例指针，NULL表示参数错误
+ * @details FSM_AddState/FSM_AddTransition从池中依次取用，池用完时返回FSM_ERR_NO_MEMORY。
+ *          一般通过FSM_STATIC_STORAGE和FSM_CREATE_STATIC使用。FSM_Destroy只停止定时器，不释放存储。
+ */
+FSM_Machine_t* FSM_CreateStatic(
+    FSM_Machine_t* machine,
+    FSM_State_t* states,
+    uint16_t max_states,
+    FSM_Transition_t* transitions,
+    uint16_t max_transitions,
+    const char* name,
+    FSM_UserData_t user_data);
+
+/**
+ * @brief 用编译态定义初始化状态机（不使用堆）
+ * @param machine 状态机实例，由调用者提供存储
+ * @param definition 编译态定义
+ * @param name 状态机名称
+ * @param user_data 用户数据
+ * @return FSM_OK表示成功，其他表示错误
+ * @note 编译态状态机不能再添加状态/转换或修改超时状态，也不需要调用FSM_Destroy
+ */
+FSM_Error_t FSM_InitCompiled(
+    FSM_Machine_t* machine,
+    const FSM_Definition_t* definition,
+    const char* name,
+    FSM_UserData_t user_data);
 
 /**
  * @brief 销毁状态机
  * @param machine 状态机实例
+ * @note 停止所有定时器；FSM_Create创建的状态机同时释放其堆内存
  */
 void FSM_Destroy(FSM_Machine_t* machine);
 
@@ -234,6 +624,36 @@ FSM_Error_t FSM_AddTransition(
     FSM_ConditionCallback_t guard,
     FSM_ActionCallback_t action);
 
+/**
+ * @brief 设置父状态，构成层次状态机
+ * @param machine 状态机实例
+ * @param state_id 子状态ID
+ * @param parent_id 父状态ID
+ * @return FSM_OK表示成功，其他表示错误
+ * @details 子状态未处理的事件交给父状态处理，逐级冒泡，公共的转换只需在父状态上声明一次。
+ *          父状态的第一个子状态默认为其初始子状态；转换到父状态时进入其初始子状态（或历史状态）。
+ *          状态机的当前状态始终是叶子状态。
+ */
+FSM_Error_t FSM_SetParent(FSM_Machine_t* machine, FSM_StateID_t state_id, FSM_StateID_t parent_id);
+
+/**
+ * @brief 设置父状态的初始子状态
+ * @param machine 状态机实例
+ * @param parent_id 父状态ID
+ * @param child_id 子状态ID，须已用FSM_SetParent()挂在该父状态下
+ * @return FSM_OK表示成功，其他表示错误
+ */
+FSM_Error_t FSM_SetInitialChild(FSM_Machine_t* machine, FSM_StateID_t parent_id, FSM_StateID_t child_id);
+
+/**
+ * @brief 设置父状态的历史状态类型
+ * @param machine 状态机实例
+ * @param state_id 父状态ID
+ * @param mode 历史状态类型
+ * @return FSM_OK表示成功，其他表示错误
+ */
+FSM_Error_t FSM_SetHistory(FSM_Machine_t* machine, FSM_StateID_t state_id, FSM_History_t mode);
+
 /**
  * @brief 设置初始状态
  * @param machine 状态机实例
@@ -253,6 +673,7 @@ FSM_Error_t FSM_Start(FSM_Machine_t* machine);
  * @brief 停止状态机
  * @param machine 状态机实例
  * @return FSM_OK表示成功，其他表示错误
+ * @note 同时停止该状态机的所有定时器；编译态状态机的存储释放前须先调用
  */
 FSM_Error_t FSM_Stop(FSM_Machine_t* machine);
 
@@ -261,21 +682,211 @@ FSM_Error_t FSM_Stop(FSM_Machine_t* machine);
  * @param machine 状态机实例
  * @param event_id 事件ID
  * @param event_data 事件数据
- * @return FSM_OK表示成功，其他表示错误
+ * @return FSM_OK表示成功，当前状态及其所有父状态都不处理该事件时返回FSM_ERR_EVENT_NOT_HANDLED
+ * @details 立即处理该事件。在状态机回调中调用时不会重入状态机，而是排队，
+ *          在最外层的FSM_SendEvent/FSM_Update返回前按顺序处理（运行到完成）。
+ *          当前状态延迟了该事件（FSM_DeferEvent）时暂存，状态改变后重新处理。
+ * @note 不能在中断中调用，中断中请使用FSM_PostEvent
  */
 FSM_Error_t FSM_SendEvent(
     FSM_Machine_t* machine,
     FSM_EventID_t event_id,
     FSM_UserData_t event_data);
 
+/**
+ * @brief 投递事件到状态机的事件队列，由FSM_ProcessEvents处理
+ * @param machine 状态机实例
+ * @param event_id 事件ID
+ * @param event_data 事件数据，处理前须保持有效（可直接把小整数转成指针传递）
+ * @return FSM_OK表示成功，FSM_ERR_QUEUE_FULL表示队列已满（事件丢弃并计入event_drops）
+ * @note 可在中断中调用
+ */
+FSM_Error_t FSM_PostEvent(
+    FSM_Machine_t* machine,
+    FSM_EventID_t event_id,
+    FSM_UserData_t event_data);
+
+/**
+ * @brief 处理事件队列中的事件
+ * @param machine 状态机实例
+ * @param budget 最多处理的事件数，0表示处理到队列为空
+ * @return 实际处理的事件数
+ * @details 由主循环调用，通过budget控制每次用于事件处理的时间。
+ *          处理过程中回调发送的事件和重新放回的延迟事件同样进入队列并计入budget。
+ */
+uint32_t FSM_ProcessEvents(FSM_Machine_t* machine, uint32_t budget);
+
+/**
+ * @brief 设置状态的延迟事件：处于该状态（或其子状态）时收到未处理的该事件先暂存，状态改变后再处理
+ * @param machine 状态机实例
+ * @param state_id 状态ID
+ * @param event_id 事件ID（0~31）
+ * @return FSM_OK表示成功，其他表示错误
+ * @note 延迟事件队列满时事件丢弃并计入event_drops；编译态状态机不支持延迟事件
+ */
+FSM_Error_t FSM_DeferEvent(FSM_Machine_t* machine, FSM_StateID_t state_id, FSM_EventID_t event_id);
+
 /**
  * @brief 更新状态机，处理超时等
  * @param machine 状态机实例
  * @param time_ms 当前系统时间(ms)
  * @return FSM_OK表示成功，其他表示错误
+ * @note 超时和on_update只针对当前叶子状态
  */
 FSM_Error_t FSM_Update(FSM_Machine_t* machine, uint32_t time_ms);
 
+/**
+ * @brief 启动状态机定时器
+ * @param machine 状态机实例
+ * @param timer_id 定时器ID（0~FSM_CONFIG_MAX_TIMERS-1），已启动时重新计时
+ * @param event_id 到期时投递到事件队列的事件，事件数据为定时器ID
+ * @param delay_ms 首次到期时间(ms)，保证不早于delay_ms，最多晚一个FSM_CONFIG_WHEEL_TICK_MS节拍
+ * @param period_ms 周期(ms)，0表示单次定时器
+ * @return FSM_OK表示成功，其他表示错误
+ * @details 所有状态机的定时器共享一个时间轮，由FSM_TimerTick()推进，未到期的定时器不产生任何开销。
+ *          到期事件由FSM_ProcessEvents()处理。
+ */
+FSM_Error_t FSM_StartTimer(
+    FSM_Machine_t* machine,
+    uint8_t timer_id,
+    FSM_EventID_t event_id,
+    uint32_t delay_ms,
+    uint32_t period_ms);
+
+/**
+ * @brief 停止状态机定时器
+ * @param machine 状态机实例
+ * @param timer_id 定时器ID
+ * @return FSM_OK表示成功，其他表示错误
+ */
+FSM_Error_t FSM_StopTimer(FSM_Machine_t* machine, uint8_t timer_id);
+
+/**
+ * @brief 检查定时器是否在运行
+ * @param machine 状态机实例
+ * @param timer_id 定时器ID
+ * @return 1表示运行中，0表示未运行
+ */
+int FSM_IsTimerActive(FSM_Machine_t* machine, uint8_t timer_id);
+
+/**
+ * @brief 推进共享时间轮，向到期定时器所属的状态机投递事件
+ * @param time_ms 当前系统时间(ms)
+ * @details 由主循环或SysTick中断周期调用，间隔不必固定；每次的开销与经过的节拍数（最多一圈）
+ *          和到期的定时器数成正比，与状态机数量无关。
+ *          有超时的状态在进入时也会在时间轮上计时，到期后由FSM_ProcessEvents()执行超时转换，
+ *          不必再为超时周期调用FSM_Update()。
+ */
+void FSM_TimerTick(uint32_t time_ms);
+
+/**
+ * @brief 为状态机挂上跟踪缓冲区（需启用FSM_CONFIG_TRACE）
+ * @param machine 状态机实例
+ * @param trace 跟踪缓冲区（清空后使用），NULL表示停止跟踪
+ * @return FSM_OK表示成功，未启用FSM_CONFIG_TRACE时返回FSM_ERR_PARAM_INVALID
+ * @details 记录启动/停止、每次转换、每次条件函数调用及结果、未处理和延迟的事件、
+ *          on_update的耗时。每条记录16字节，写满后覆盖最旧的记录。
+ */
+FSM_Error_t FSM_TraceAttach(FSM_Machine_t* machine, FSM_Trace_t* trace);
+
+/**
+ * @brief 通过FSM_PRINTF按时间顺序导出跟踪缓冲区，供主机端解码器解析
+ * @param machine 状态机实例
+ * @details 不分配内存、不进入临界区，可在HardFault或看门狗提前唤醒中断中调用（事后导出）。
+ *          输出格式：
+ *          - FSM-TRACE-BEGIN <写入总数> <缓冲区记录数> <状态机名称>
+ *          - S <状态ID> <状态名称>（每个状态一行）
+ *          - R <timestamp> <cycles> <kind> <from> <to> <event> <guard>（十六进制，每条记录一行）
+ *          - FSM-TRACE-END
+ */
+void FSM_TraceDump(FSM_Machine_t* machine);
+
+/**
+ * @brief 设置跟踪记录回调耗时使用的周期计数器
+ * @param counter 计数器读取函数，NULL表示不记录耗时
+ * @note Cortex-M3/M4上默认读取DWT->CYCCNT，需先调用DWT_Delay_Init()使能计数器
+ */
+void FSM_SetCycleCounter(FSM_CycleCounter_t counter);
+
+/**
+ * @brief 初始化机器组
+ * @param group 机器组
+ * @param definition 所有实例共享的编译态定义
+ * @param name 机器组名称
+ * @param state 当前状态ID数组（count项）
+ * @param enter_time 进入时间数组（count项）
+ * @param deadline 超时时刻数组（count项）
+ * @param user_data 用户数据数组（count项，初始化为NULL）
+ * @param count 实例数量
+ * @return FSM_OK表示成功，其他表示错误
+ * @note 一般通过FSM_GROUP_STORAGE和FSM_GROUP_INIT使用；实例不支持定时器和FSM_PostEvent
+ */
+FSM_Error_t FSM_GroupInit(
+    FSM_Group_t* group,
+    const FSM_Definition_t* definition,
+    const char* name,
+    uint16_t* state,
+    uint32_t* enter_time,
+    uint32_t* deadline,
+    FSM_UserData_t* user_data,
+    uint16_t count);
+
+/**
+ * @brief 设置机器组实例的用户数据
+ * @param group 机器组
+ * @param index 实例序号
+ * @param user_data 用户数据，回调中通过user_data参数取得
+ * @return FSM_OK表示成功，其他表示错误
+ */
+FSM_Error_t FSM_GroupSetUserData(FSM_Group_t* group, uint16_t index, FSM_UserData_t user_data);
+
+/**
+ * @brief 启动机器组的所有实例（各自进入初始状态）
+ * @param group 机器组
+ * @param time_ms 当前系统时间(ms)
+ * @return FSM_OK表示成功，否则为第一个出错实例的错误码
+ */
+FSM_Error_t FSM_GroupStart(FSM_Group_t* group, uint32_t time_ms);
+
+/**
+ * @brief 向机器组的一个实例发送事件
+ * @param group 机器组
+ * @param index 实例序号
+ * @param event_id 事件ID
+ * @param event_data 事件数据
+ * @return 同FSM_SendEvent；在本组的回调中调用时返回FSM_ERR_STATE_ACTIVE
+ */
+FSM_Error_t FSM_GroupSendEvent(
+    FSM_Group_t* group,
+    uint16_t index,
+    FSM_EventID_t event_id,
+    FSM_UserData_t event_data);
+
+/**
+ * @brief 更新机器组：扫描所有实例的超时，再调用带on_update状态的更新回调
+ * @param group 机器组
+ * @param time_ms 当前系统时间(ms)
+ * @return 本次执行超时转换的实例数
+ * @details 超时扫描只顺序读取超时时刻数组，未到期的实例不访问状态表；
+ *          定义中没有on_update时不做第二遍扫描。
+ */
+uint32_t FSM_GroupUpdate(FSM_Group_t* group, uint32_t time_ms);
+
+/**
+ * @brief 获取机器组实例的当前状态ID
+ * @param group 机器组
+ * @param index 实例序号
+ * @return 当前状态ID，未启动或出错返回0
+ */
+FSM_StateID_t FSM_GroupGetState(FSM_Group_t* group, uint16_t index);
+
+/**
+ * @brief 在机器组的回调中获取正在处理的实例序号
+ * @param machine 回调收到的状态机（机器组的view）
+ * @return 实例序号，machine不属于机器组时返回0xFFFF
+ */
+uint16_t FSM_GroupGetIndex(FSM_Machine_t* machine);
+
 /**
  * @brief 获取当前状态ID
  * @param machine 状态机实例
@@ -301,7 +912,7 @@ FSM_StateID_t FSM_GetPreviousState(FSM_Machine_t* machine);
  * @brief 检查是否处于指定状态
  * @param machine 状态机实例
  * @param state_id 状态ID
- * @return 1表示是，0表示否
+ * @return 1表示是（当前叶子状态或其任一父状态），0表示否
  */
 int FSM_IsInState(FSM_Machine_t* machine, FSM_StateID_t state_id);
 
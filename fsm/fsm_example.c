@@ -206,6 +206,59 @@ FSM_Error_t do_reset(FSM_Machine_t* machine, FSM_Transition_t* transition,
     return FSM_OK;
 }
 
+/* 编译态定义：与main()中动态构建的状态机等价，状态和转换都是常量表 */
+#define EVENT_COUNT     7
+
+static const FSM_State_t device_states[] = {
+    FSM_STATE_DEF(STATE_IDLE,    "空闲",   on_enter_idle,    on_exit_idle,    NULL,              0, NULL),
+    FSM_STATE_DEF(STATE_WORKING, "工作中", on_enter_working, on_exit_working, on_update_working,
+                  10000, FSM_STATE_REF(device_states, STATE_IDLE)),
+    FSM_STATE_DEF(STATE_ERROR,   "错误",   on_enter_error,   on_exit_error,   NULL,              0, NULL),
+    FSM_STATE_DEF(STATE_PAUSE,   "暂停",   on_enter_pause,   NULL,            NULL,              0, NULL),
+};
+
+static const FSM_Transition_t device_table[4][EVENT_COUNT] = {
+    FSM_ON(STATE_IDLE,    STATE_WORKING, EVENT_START,  NULL, NULL),
+    FSM_ON(STATE_WORKING, STATE_IDLE,    EVENT_STOP,   NULL, NULL),
+    FSM_ON(STATE_WORKING, STATE_ERROR,   EVENT_ERROR,  NULL, NULL),
+    FSM_ON(STATE_WORKING, STATE_PAUSE,   EVENT_PAUSE,  NULL, NULL),
+    FSM_ON(STATE_ERROR,   STATE_IDLE,    EVENT_RESET,  check_can_reset, do_reset),
+    FSM_ON(STATE_PAUSE,   STATE_WORKING, EVENT_RESUME, NULL, NULL),
+};
+
+static const FSM_Definition_t device_definition =
+    FSM_DEFINITION(device_states, device_table, STATE_IDLE);
+
+/**
+ * @brief 编译态状态机示例：不使用堆，事件分派为一次查表
+ */
+static void compiled_example(Device_Data_t* device_data)
+{
+    FSM_Machine_t machine;
+    
+    if (FSM_InitCompiled(&machine, &device_definition, "设备控制(编译态)", device_data) != FSM_OK) {
+        printf("初始化编译态状态机失败\n");
+        return;
+    }
+    machine.time_now = get_system_time();  // 启动前同步当前时间，超时从此刻计起
+    FSM_Start(&machine);
+    
+    FSM_SendEvent(&machine, EVENT_START, NULL);
+    FSM_SendEvent(&machine, EVENT_PAUSE, NULL);
+    FSM_SendEvent(&machine, EVENT_RESUME, NULL);
+    
+    while (FSM_IsInState(&machine, STATE_WORKING)) {
+        simulate_time_passing(500);
+        FSM_Update(&machine, get_system_time());
+    }
+    
+    printf("编译态状态机最终状态: %s, 转换次数: %u\n",
+           FSM_GetCurrentStateName(&machine), FSM_GetTransitionCount(&machine));
+    
+    // 状态机存储在栈上，返回前停止（摘下时间轮上的定时器）
+    FSM_Stop(&machine);
+}
+
 /**
  * @brief 主函数
  */
@@ -346,5 +399,8 @@ int main(void)
     // 清理
     FSM_Destroy(machine);
     
+    printf("\n=== 编译态状态机示例 ===\n");
+    compiled_example(&device_data);
+    
     return 0;
 } 
\ No newline at end of file
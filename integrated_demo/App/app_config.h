@@ -58,17 +58,19 @@ extern "C" {
 #define FSM_MAX_TRANSITIONS       20      // 最大转换数
 #define FSM_DEFAULT_TIMEOUT       5000    // 默认超时时间(ms)
 #define FSM_UPDATE_INTERVAL       10      // 状态机更新间隔(ms)
+#define FSM_EVENT_BUDGET          4       // 每次更新最多处理的排队事件数
 
 /* 应用状态定义 */
 typedef enum {
-    STATE_INIT = 0,               // 初始化状态
+    STATE_INIT = 1,               // 初始化状态（FSM状态ID从1开始，0保留给"无状态"）
     STATE_IDLE,                   // 空闲状态
     STATE_MENU,                   // 菜单状态
     STATE_DATA_DISPLAY,           // 数据显示状态
     STATE_SETTINGS,               // 设置状态
     STATE_ALARM,                  // 告警状态
     STATE_SLEEP,                  // 休眠状态
-    STATE_ERROR                   // 错误状态
+    STATE_ERROR,                  // 错误状态
+    STATE_ACTIVE                  // 运行状态（空闲/菜单/数据显示/设置的父状态）
 } AppState_t;
 
 /* 应用事件定义 */
@@ -10,6 +10,9 @@
 /* 全局变量 */
 FSM_Machine_t* AppFSM = NULL;
 
+/* 状态机静态存储：状态和转换不从堆分配，占用内存在链接时确定 */
+static FSM_STATIC_STORAGE(app_fsm_storage, FSM_MAX_STATES, FSM_MAX_TRANSITIONS);
+
 /* 辅助函数定义 */
 static void UpdateScreenBasedOnState(AppState_t state);
 
@@ -21,8 +24,8 @@ int AppFSM_Init(void)
 {
     FSM_Error_t result;
     
-    // 创建状态机
-    AppFSM = FSM_CreateMachine("AppFSM", NULL);
+    // 在静态存储中创建状态机
+    AppFSM = FSM_CREATE_STATIC(app_fsm_storage, "AppFSM", NULL);
     if (AppFSM == NULL) {
         return -1;
     }
@@ -52,6 +55,17 @@ int AppFSM_Init(void)
                          AppFSM_ErrorExit, AppFSM_ErrorUpdate, 0);
     if (result != FSM_OK) return -2;
     
+    // 运行状态：空闲/菜单/数据显示/设置共同的父状态，公共转换只在这里声明一次
+    result = FSM_AddState(AppFSM, STATE_ACTIVE, "运行", NULL, NULL, NULL, 0);
+    if (result != FSM_OK) return -2;
+    
+    if (FSM_SetParent(AppFSM, STATE_IDLE, STATE_ACTIVE) != FSM_OK ||
+        FSM_SetParent(AppFSM, STATE_MENU, STATE_ACTIVE) != FSM_OK ||
+        FSM_SetParent(AppFSM, STATE_DATA_DISPLAY, STATE_ACTIVE) != FSM_OK ||
+        FSM_SetParent(AppFSM, STATE_SETTINGS, STATE_ACTIVE) != FSM_OK) {
+        return -2;
+    }
+    
     // 添加转换规则
     // 从初始化到空闲
     result = FSM_AddTransition(AppFSM, STATE_INIT, STATE_IDLE, EVENT_INIT_DONE, 
@@ -83,8 +97,8 @@ int AppFSM_Init(void)
                               NULL, NULL);
     if (result != FSM_OK) return -3;
     
-    // 从空闲到错误
-    result = FSM_AddTransition(AppFSM, STATE_IDLE, STATE_ERROR, EVENT_ERROR, 
+    // 运行中任一子状态出错都转到错误状态（子状态未处理的事件冒泡到父状态）
+    result = FSM_AddTransition(AppFSM, STATE_ACTIVE, STATE_ERROR, EVENT_ERROR, 
                               NULL, NULL);
     if (result != FSM_OK) return -3;
     
@@ -111,6 +125,8 @@ int AppFSM_Init(void)
 void AppFSM_Update(uint32_t current_time)
 {
     if (AppFSM) {
+        // 先处理按键中断投递的事件，每次最多FSM_EVENT_BUDGET个
+        FSM_ProcessEvents(AppFSM, FSM_EVENT_BUDGET);
         FSM_Update(AppFSM, current_time);
     }
 }
@@ -128,8 +144,8 @@ void AppFSM_SendButtonEvent(BTN_ID_t button_id, BTN_Event_t event, void* user_da
     // 创建按键事件参数，高16位为按键ID，低16位为按键事件类型
     uint32_t event_param = (button_id << 16) | event;
     
-    // 发送按键事件到状态机
-    FSM_SendEvent(AppFSM, EVENT_KEY_PRESS, &event_param);
+    // 投递按键事件到状态机队列（可能在按键中断中调用），参数值直接存放在事件数据中
+    FSM_PostEvent(AppFSM, EVENT_KEY_PRESS, (FSM_UserData_t)(uintptr_t)event_param);
 }
 
 /* 状态回调函数实现 */
@@ -290,7 +306,7 @@ int AppFSM_CanMenuToDataDisplay(FSM_Machine_t* machine, FSM_Transition_t* transi
 {
     // 检查是否是OK按键按下事件
     if (event && event->data) {
-        uint32_t event_param = *(uint32_t*)event->data;
+        uint32_t event_param = (uint32_t)(uintptr_t)event->data;
         uint16_t button_id = (event_param >> 16) & 0xFFFF;
         uint16_t button_event = event_param & 0xFFFF;
         
@@ -0,0 +1,134 @@
+#include "msgbus.h"
+#include "main.h"
+#include <stdio.h>
+
+/*
+ * 消息总线示例：传感器采样一次，扇出给显示、日志和MQTT上传三个任务
+ *
+ * 采样任务只发布到 TOPIC_SENSOR，不需要知道有哪些消费者；
+ * 负载只存一份，三个订阅任务的队列里各有一个指向它的指针。
+ */
+
+#define TOPIC_SENSOR    1   // 传感器采样
+#define TOPIC_ALARM     2   // 报警
+
+/* 传感器采样 */
+typedef struct {
+    uint32_t tick;          // 采样时间
+    float temperature;      // 温度（℃）
+    float humidity;         // 湿度（%）
+} SensorSample_t;
+
+/* 任务句柄 */
+static TaskHandle_t* sensor_task = NULL;
+static TaskHandle_t* ui_task = NULL;
+static TaskHandle_t* log_task = NULL;
+static TaskHandle_t* mqtt_task = NULL;
+
+/**
+ * @brief 采样任务：每秒采样一次并发布
+ */
+static void Sensor_Task(void* param) {
+    SensorSample_t sample;
+    (void)param;
+
+    sample.tick = HAL_GetTick();
+    sample.temperature = 25.0f;     // 实际工程中读取传感器
+    sample.humidity = 60.0f;
+
+    MsgBus_Publish(TOPIC_SENSOR, &sample, sizeof(sample), 0);
+
+    // 超过阈值时以更高优先级发布报警：任务消息队列按消息优先级出队（TM_CONFIG_QUEUE_PRIORITY，默认开启），
+    // 订阅者会先于积压的采样收到它；关闭该配置时队列先进先出，报警排在积压的采样之后
+    if (sample.temperature > 50.0f) {
+        MsgBus_Publish(TOPIC_ALARM, &sample, sizeof(sample), 10);
+    }
+}
+
+/**
+ * @brief 显示任务：订阅采样和报警
+ */
+static void UI_Task(void* param) {
+    const MsgBusMsg_t* msg;
+    (void)param;
+
+    while ((msg = MsgBus_Receive(ui_task)) != NULL) {
+        const SensorSample_t* sample = (const SensorSample_t*)msg->data;
+        if (msg->topic == TOPIC_ALARM) {
+            printf("UI: 温度报警 %.1f\r\n", sample->temperature);
+        } else {
+            printf("UI: %.1f℃ %.1f%%\r\n", sample->temperature, sample->humidity);
+        }
+        MsgBus_Release(msg);
+    }
+}
+
+/**
+ * @brief 日志任务：订阅采样
+ */
+static void Log_Task(void* param) {
+    const MsgBusMsg_t* msg;
+    (void)param;
+
+    while ((msg = MsgBus_Receive(log_task)) != NULL) {
+        const SensorSample_t* sample = (const SensorSample_t*)msg->data;
+        printf("LOG: [%lu] %.1f %.1f\r\n", (unsigned long)sample->tick, sample->temperature, sample->humidity);
+        MsgBus_Release(msg);
+    }
+}
+
+/**
+ * @brief MQTT上传任务：订阅采样（上传较慢，队列满时丢弃的采样计入统计）
+ */
+static void Mqtt_Task(void* param) {
+    const MsgBusMsg_t* msg;
+    (void)param;
+
+    msg = MsgBus_Receive(mqtt_task);
+    if (msg != NULL) {
+        // 实际工程中在此序列化并发布到MQTT服务器
+        MsgBus_Release(msg);
+    }
+}
+
+/**
+ * @brief 每10秒打印一次总线统计
+ */
+static void Stats_Task(void* param) {
+    MsgBusStats_t stats;
+    (void)param;
+
+    MsgBus_GetStats(&stats);
+    printf("BUS: 发布 %lu 投递 %lu 丢弃 %lu 消息块 %u/%u (峰值 %u)\r\n",
+           (unsigned long)stats.published, (unsigned long)stats.delivered, (unsigned long)stats.drops,
+           stats.blocks_in_use, MSGBUS_CONFIG_BLOCKS, stats.blocks_peak);
+}
+
+/**
+ * @brief 消息总线示例初始化
+ */
+void MsgBus_Example_Init(void) {
+    if (TaskManager_Init(8) != 0) {
+        printf("任务管理器初始化失败!\r\n");
+        return;
+    }
+    MsgBus_Init();
+
+    sensor_task = TaskManager_CreateTask("SENSOR", Sensor_Task, NULL, 2, 1000);
+    ui_task = TaskManager_CreateTask("UI", UI_Task, NULL, 3, 100);
+    log_task = TaskManager_CreateTask("LOG", Log_Task, NULL, 4, 500);
+    mqtt_task = TaskManager_CreateTask("MQTT", Mqtt_Task, NULL, 5, 2000);
+    TaskManager_CreateTask("STATS", Stats_Task, NULL, 6, 10000);
+
+    // 订阅任务的队列只存放消息块指针
+    TaskManager_CreateTaskQueue(ui_task, 8, MSGBUS_QUEUE_MSG_SIZE);
+    TaskManager_CreateTaskQueue(log_task, 8, MSGBUS_QUEUE_MSG_SIZE);
+    TaskManager_CreateTaskQueue(mqtt_task, 2, MSGBUS_QUEUE_MSG_SIZE);
+
+    MsgBus_Subscribe(TOPIC_SENSOR, ui_task);
+    MsgBus_Subscribe(TOPIC_ALARM, ui_task);
+    MsgBus_Subscribe(TOPIC_SENSOR, log_task);
+    MsgBus_Subscribe(TOPIC_SENSOR, mqtt_task);
+
+    TaskManager_StartScheduler();
+}
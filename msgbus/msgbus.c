@@ -0,0 +1,328 @@
+#include "msgbus.h"
+#include <string.h>
+
+#define MSGBUS_NONE     0xFFU
+
+/* 主题表项：订阅者以单链表挂在subs[]中 */
+typedef struct {
+    MsgBusTopic_t id;
+    uint8_t first_sub;
+} MsgBusTopicEntry_t;
+
+/* 订阅表项：按任务ID记录，订阅任务被删除后自动失效 */
+typedef struct {
+    TaskId_t task_id;
+    uint8_t next;
+} MsgBusSub_t;
+
+static struct {
+    MsgBusTopicEntry_t topics[MSGBUS_CONFIG_MAX_TOPICS];
+    uint8_t topic_count;
+    MsgBusSub_t subs[MSGBUS_CONFIG_MAX_SUBS];
+    uint8_t free_sub;                               // 空闲订阅表项链表头
+    MsgBusMsg_t blocks[MSGBUS_CONFIG_BLOCKS];
+    uint8_t free_blocks[MSGBUS_CONFIG_BLOCKS];      // 空闲消息块序号栈
+    uint8_t free_block_count;
+    MsgBusStats_t stats;
+} g_msgbus;
+
+/* 查找主题，返回主题表下标，不存在时返回MSGBUS_NONE */
+static uint8_t msgbus_find_topic(MsgBusTopic_t topic) {
+    for (uint8_t i = 0; i < g_msgbus.topic_count; i++) {
+        if (g_msgbus.topics[i].id == topic) {
+            return i;
+        }
+    }
+    return MSGBUS_NONE;
+}
+
+/* 从主题的订阅链表中摘下一项并放回空闲链表；prev为MSGBUS_NONE表示sub是链表头 */
+static void msgbus_unlink_sub(uint8_t topic_index, uint8_t prev, uint8_t sub) {
+    if (prev == MSGBUS_NONE) {
+        g_msgbus.topics[topic_index].first_sub = g_msgbus.subs[sub].next;
+    } else {
+        g_msgbus.subs[prev].next = g_msgbus.subs[sub].next;
+    }
+    g_msgbus.subs[sub].next = g_msgbus.free_sub;
+    g_msgbus.free_sub = sub;
+
+    // 主题已无订阅者时释放主题表项（与最后一项交换）
+    if (g_msgbus.topics[topic_index].first_sub == MSGBUS_NONE) {
+        g_msgbus.topic_count--;
+        g_msgbus.topics[topic_index] = g_msgbus.topics[g_msgbus.topic_count];
+    }
+}
+
+/* 订阅者队列的丢弃回调：块指针被挤出/合并覆盖/清空/随任务删除时释放其持有，避免消息块泄漏 */
+static void msgbus_queue_drop(MSGQUEUE_HandleTypeDef* hqueue, const uint8_t* data, uint16_t size) {
+    MsgBusMsg_t* msg;
+    (void)hqueue;
+
+    if (size != sizeof(msg)) {
+        return;
+    }
+    memcpy(&msg, data, sizeof(msg));
+    // 只处理指向消息块池的指针（防御误混入队列的其他消息）
+    if (msg >= &g_msgbus.blocks[0] && msg < &g_msgbus.blocks[MSGBUS_CONFIG_BLOCKS] &&
+        msg == &g_msgbus.blocks[msg->index]) {
+        MsgBus_Release(msg);
+    }
+}
+
+/**
+ * @brief  初始化消息总线（清空所有主题和订阅，回收所有消息块）
+ * @retval 0:成功
+ */
+uint8_t MsgBus_Init(void) {
+    memset(&g_msgbus, 0, sizeof(g_msgbus));
+
+    for (uint8_t i = 0; i < MSGBUS_CONFIG_MAX_SUBS; i++) {
+        g_msgbus.subs[i].next = (uint8_t)((i + 1U < MSGBUS_CONFIG_MAX_SUBS) ? i + 1U : MSGBUS_NONE);
+    }
+    g_msgbus.free_sub = 0;
+
+    for (uint8_t i = 0; i < MSGBUS_CONFIG_BLOCKS; i++) {
+        g_msgbus.blocks[i].index = i;
+        g_msgbus.free_blocks[i] = i;
+    }
+    g_msgbus.free_block_count = MSGBUS_CONFIG_BLOCKS;
+
+    return 0;
+}
+
+/**
+ * @brief  订阅主题
+ * @param  topic: 主题ID
+ * @param  task: 订阅任务
+ * @retval 0:成功 1:参数错误（含任务没有能存放块指针的消息队列） 2:主题表已满 3:订阅表已满
+ */
+uint8_t MsgBus_Subscribe(MsgBusTopic_t topic, TaskHandle_t* task) {
+    TaskId_t task_id = TaskManager_GetTaskId(task);
+    if (task_id == TASK_ID_INVALID || task->queue == NULL || task->queue->max_msg_size < MSGBUS_QUEUE_MSG_SIZE) {
+        return 1;
+    }
+
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+
+    // 队列以任何方式丢弃块指针时都要释放对应的持有
+    MSGQUEUE_SetDropHook(task->queue, msgbus_queue_drop);
+
+    uint8_t t = msgbus_find_topic(topic);
+    if (t == MSGBUS_NONE) {
+        if (g_msgbus.topic_count >= MSGBUS_CONFIG_MAX_TOPICS) {
+            TM_CRITICAL_EXIT(irq_state);
+            return 2;
+        }
+        t = g_msgbus.topic_count++;
+        g_msgbus.topics[t].id = topic;
+        g_msgbus.topics[t].first_sub = MSGBUS_NONE;
+    }
+
+    // 已订阅则直接返回
+    for (uint8_t s = g_msgbus.topics[t].first_sub; s != MSGBUS_NONE; s = g_msgbus.subs[s].next) {
+        if (g_msgbus.subs[s].task_id == task_id) {
+            TM_CRITICAL_EXIT(irq_state);
+            return 0;
+        }
+    }
+
+    uint8_t s = g_msgbus.free_sub;
+    if (s == MSGBUS_NONE) {
+        if (g_msgbus.topics[t].first_sub == MSGBUS_NONE) {
+            g_msgbus.topic_count--;  // 回收刚创建的空主题
+        }
+        TM_CRITICAL_EXIT(irq_state);
+        return 3;
+    }
+    g_msgbus.free_sub = g_msgbus.subs[s].next;
+    g_msgbus.subs[s].task_id = task_id;
+    g_msgbus.subs[s].next = g_msgbus.topics[t].first_sub;
+    g_msgbus.topics[t].first_sub = s;
+
+    TM_CRITICAL_EXIT(irq_state);
+    return 0;
+}
+
+/**
+ * @brief  取消订阅
+ * @param  topic: 主题ID
+ * @param  task: 订阅任务
+ * @retval 0:成功 1:未订阅
+ */
+uint8_t MsgBus_Unsubscribe(MsgBusTopic_t topic, TaskHandle_t* task) {
+    TaskId_t task_id = TaskManager_GetTaskId(task);
+    uint8_t result = 1;
+
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+
+    uint8_t t = msgbus_find_topic(topic);
+    if (t != MSGBUS_NONE && task_id != TASK_ID_INVALID) {
+        uint8_t prev = MSGBUS_NONE;
+        for (uint8_t s = g_msgbus.topics[t].first_sub; s != MSGBUS_NONE; prev = s, s = g_msgbus.subs[s].next) {
+            if (g_msgbus.subs[s].task_id == task_id) {
+                msgbus_unlink_sub(t, prev, s);
+                result = 0;
+                break;
+            }
+        }
+    }
+
+    TM_CRITICAL_EXIT(irq_state);
+    return result;
+}
+
+/**
+ * @brief  申请一个空的消息块
+ * @retval 消息块，耗尽时返回NULL
+ */
+MsgBusMsg_t* MsgBus_Alloc(void) {
+    MsgBusMsg_t* msg = NULL;
+
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    if (g_msgbus.free_block_count > 0) {
+        msg = &g_msgbus.blocks[g_msgbus.free_blocks[--g_msgbus.free_block_count]];
+        msg->refcount = 1;  // 申请者持有
+        msg->size = 0;
+        g_msgbus.stats.blocks_in_use++;
+        if (g_msgbus.stats.blocks_in_use > g_msgbus.stats.blocks_peak) {
+            g_msgbus.stats.blocks_peak = g_msgbus.stats.blocks_in_use;
+        }
+    } else {
+        g_msgbus.stats.no_block++;
+    }
+    TM_CRITICAL_EXIT(irq_state);
+
+    return msg;
+}
+
+/**
+ * @brief  发布MsgBus_Alloc()申请的消息块
+ * @param  topic: 主题ID
+ * @param  msg: 消息块
+ * @param  priority: 投递到订阅者任务队列的消息优先级
+ * @retval 投递成功的订阅者数量
+ */
+uint8_t MsgBus_PublishMsg(MsgBusTopic_t topic, MsgBusMsg_t* msg, uint32_t priority) {
+    uint8_t delivered = 0;
+
+    if (msg == NULL) {
+        return 0;
+    }
+    msg->topic = topic;
+    msg->timestamp = HAL_GetTick();
+
+    // 整个扇出在一个临界区内完成：每个订阅者只复制一个指针，与负载大小无关
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    g_msgbus.stats.published++;
+
+    uint8_t t = msgbus_find_topic(topic);
+    uint8_t prev = MSGBUS_NONE;
+    uint8_t s = (t != MSGBUS_NONE) ? g_msgbus.topics[t].first_sub : MSGBUS_NONE;
+    while (s != MSGBUS_NONE) {
+        uint8_t next = g_msgbus.subs[s].next;
+        TaskHandle_t* task = TaskManager_GetTaskById(g_msgbus.subs[s].task_id);
+
+        if (task == NULL) {
+            // 订阅任务已删除：顺便移除订阅（主题随之释放时停止遍历）
+            uint8_t last_sub = (prev == MSGBUS_NONE && next == MSGBUS_NONE);
+            msgbus_unlink_sub(t, prev, s);
+            if (last_sub) {
+                break;
+            }
+            s = next;
+            continue;
+        }
+
+        uint8_t refcount = ++msg->refcount;
+        if (TaskManager_SendTaskMessage(task, &msg, sizeof(msg), priority) != 0) {
+            msg->refcount--;
+            g_msgbus.stats.drops++;
+        } else if (msg->refcount != refcount) {
+            // DROP_NEWEST策略的队列返回成功但丢弃了本条消息，丢弃回调已释放这份引用
+            g_msgbus.stats.drops++;
+        } else {
+            delivered++;
+        }
+        prev = s;
+        s = next;
+    }
+    g_msgbus.stats.delivered += delivered;
+    TM_CRITICAL_EXIT(irq_state);
+
+    // 释放发布者的持有，无人订阅时消息块立即回收
+    MsgBus_Release(msg);
+    return delivered;
+}
+
+/**
+ * @brief  发布消息：负载复制一次到共享消息块，再向每个订阅者投递块指针
+ * @param  topic: 主题ID
+ * @param  data: 负载
+ * @param  size: 负载大小
+ * @param  priority: 投递到订阅者任务队列的消息优先级
+ * @retval 投递成功的订阅者数量
+ */
+uint8_t MsgBus_Publish(MsgBusTopic_t topic, const void* data, uint16_t size, uint32_t priority) {
+    if ((data == NULL && size > 0) || size > MSGBUS_CONFIG_BLOCK_SIZE) {
+        return 0;
+    }
+
+    MsgBusMsg_t* msg = MsgBus_Alloc();
+    if (msg == NULL) {
+        return 0;
+    }
+    if (size > 0) {
+        memcpy(msg->data, data, size);
+    }
+    msg->size = size;
+
+    return MsgBus_PublishMsg(topic, msg, priority);
+}
+
+/**
+ * @brief  订阅任务从自己的队列中取出一条总线消息
+ * @param  task: 订阅任务
+ * @retval 消息块，无消息时返回NULL
+ */
+const MsgBusMsg_t* MsgBus_Receive(TaskHandle_t* task) {
+    MsgBusMsg_t* msg = NULL;
+    uint16_t size = 0;
+
+    if (TaskManager_ReceiveTaskMessage(task, &msg, sizeof(msg), &size) != 0 || size != sizeof(msg)) {
+        return NULL;
+    }
+    return msg;
+}
+
+/**
+ * @brief  释放一次对消息块的持有，最后一个持有者释放时消息块回收
+ * @param  msg: 消息块
+ */
+void MsgBus_Release(const MsgBusMsg_t* msg) {
+    if (msg == NULL) {
+        return;
+    }
+
+    MsgBusMsg_t* block = &g_msgbus.blocks[msg->index];
+
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    if (block->refcount > 0 && --block->refcount == 0) {
+        g_msgbus.free_blocks[g_msgbus.free_block_count++] = block->index;
+        g_msgbus.stats.blocks_in_use--;
+    }
+    TM_CRITICAL_EXIT(irq_state);
+}
+
+/**
+ * @brief  获取总线统计信息
+ * @param  stats: 输出统计信息
+ */
+void MsgBus_GetStats(MsgBusStats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    *stats = g_msgbus.stats;
+    TM_CRITICAL_EXIT(irq_state);
+}
@@ -0,0 +1,130 @@
+#ifndef __MSGBUS_H
+#define __MSGBUS_H
+
+#include "taskmanager.h"
+#include <stdint.h>
+
+/* 主题数量上限 */
+#ifndef MSGBUS_CONFIG_MAX_TOPICS
+#define MSGBUS_CONFIG_MAX_TOPICS    16
+#endif
+
+/* 所有主题的订阅总数上限 */
+#ifndef MSGBUS_CONFIG_MAX_SUBS
+#define MSGBUS_CONFIG_MAX_SUBS      32
+#endif
+
+/* 共享消息块数量（同时在途的已发布消息数上限） */
+#ifndef MSGBUS_CONFIG_BLOCKS
+#define MSGBUS_CONFIG_BLOCKS        8
+#endif
+
+/* 每个消息块的最大负载（字节） */
+#ifndef MSGBUS_CONFIG_BLOCK_SIZE
+#define MSGBUS_CONFIG_BLOCK_SIZE    64
+#endif
+
+#if (MSGBUS_CONFIG_MAX_SUBS > 254) || (MSGBUS_CONFIG_BLOCKS > 254) || (MSGBUS_CONFIG_MAX_TOPICS > 254)
+#error "MSGBUS_CONFIG_MAX_SUBS/BLOCKS/MAX_TOPICS must not exceed 254"
+#endif
+
+/* 主题ID */
+typedef uint16_t MsgBusTopic_t;
+
+/**
+ * 共享消息块：负载只存一份，每个订阅者的任务队列中只投递指向它的指针
+ */
+typedef struct {
+    MsgBusTopic_t topic;                    // 主题
+    uint16_t size;                          // 负载大小
+    uint8_t refcount;                       // 尚未释放的持有者数量
+    uint8_t index;                          // 在消息块池中的序号
+    uint32_t timestamp;                     // 发布时间
+    uint8_t data[MSGBUS_CONFIG_BLOCK_SIZE]; // 负载
+} MsgBusMsg_t;
+
+/**
+ * 总线统计信息
+ */
+typedef struct {
+    uint32_t published;                     // 发布的消息数
+    uint32_t delivered;                     // 投递到订阅者的次数
+    uint32_t drops;                         // 订阅者队列满（含DROP_NEWEST策略丢弃新消息）/无队列导致的丢弃次数
+    uint32_t no_block;                      // 消息块耗尽导致的发布失败次数
+    uint8_t blocks_in_use;                  // 当前在途消息块数
+    uint8_t blocks_peak;                    // 在途消息块数峰值
+} MsgBusStats_t;
+
+/* 订阅者任务队列每条消息的最小大小（存放一个消息块指针） */
+#define MSGBUS_QUEUE_MSG_SIZE       ((uint16_t)sizeof(MsgBusMsg_t*))
+
+/**
+ * @brief  初始化消息总线（清空所有主题和订阅，回收所有消息块）
+ * @retval 0:成功
+ */
+uint8_t MsgBus_Init(void);
+
+/**
+ * @brief  订阅主题
+ * @param  topic: 主题ID
+ * @param  task: 订阅任务，须已用TaskManager_CreateTaskQueue()创建消息大小不小于MSGBUS_QUEUE_MSG_SIZE的队列
+ * @retval 0:成功 1:参数错误（含任务没有符合要求的消息队列） 2:主题表已满 3:订阅表已满
+ * @note   同一任务重复订阅同一主题不会重复投递；订阅时在任务队列上安装丢弃回调，
+ *         块指针被挤出/合并覆盖/MSGQUEUE_Clear()清空或任务被删除时自动释放消息块
+ */
+uint8_t MsgBus_Subscribe(MsgBusTopic_t topic, TaskHandle_t* task);
+
+/**
+ * @brief  取消订阅
+ * @param  topic: 主题ID
+ * @param  task: 订阅任务
+ * @retval 0:成功 1:未订阅
+ */
+uint8_t MsgBus_Unsubscribe(MsgBusTopic_t topic, TaskHandle_t* task);
+
+/**
+ * @brief  发布消息：负载复制一次到共享消息块，再向每个订阅者投递块指针
+ * @param  topic: 主题ID
+ * @param  data: 负载
+ * @param  size: 负载大小，不超过MSGBUS_CONFIG_BLOCK_SIZE
+ * @param  priority: 投递到订阅者任务队列的消息优先级
+ * @retval 投递成功的订阅者数量（无订阅者、消息块耗尽或参数错误时为0）
+ * @note   可在中断中调用
+ */
+uint8_t MsgBus_Publish(MsgBusTopic_t topic, const void* data, uint16_t size, uint32_t priority);
+
+/**
+ * @brief  申请一个空的消息块，由调用者直接写入负载后用MsgBus_PublishMsg()发布（零拷贝）
+ * @retval 消息块，耗尽时返回NULL
+ */
+MsgBusMsg_t* MsgBus_Alloc(void);
+
+/**
+ * @brief  发布MsgBus_Alloc()申请的消息块，发布后调用者不再持有该块
+ * @param  topic: 主题ID
+ * @param  msg: 消息块（size字段须已填写）
+ * @param  priority: 投递到订阅者任务队列的消息优先级
+ * @retval 投递成功的订阅者数量
+ */
+uint8_t MsgBus_PublishMsg(MsgBusTopic_t topic, MsgBusMsg_t* msg, uint32_t priority);
+
+/**
+ * @brief  订阅任务从自己的队列中取出一条总线消息
+ * @param  task: 订阅任务
+ * @retval 消息块（只读），无消息时返回NULL；处理完后须调用MsgBus_Release()
+ */
+const MsgBusMsg_t* MsgBus_Receive(TaskHandle_t* task);
+
+/**
+ * @brief  释放一次对消息块的持有，最后一个持有者释放时消息块回收
+ * @param  msg: 消息块
+ */
+void MsgBus_Release(const MsgBusMsg_t* msg);
+
+/**
+ * @brief  获取总线统计信息
+ * @param  stats: 输出统计信息
+ */
+void MsgBus_GetStats(MsgBusStats_t* stats);
+
+#endif /* __MSGBUS_H */
@@ -0,0 +1,280 @@
+/**
+ * @file bench_msgqueue.c
+ * @brief 消息队列吞吐量与延迟的主机端基准测试
+ * @details 对先进先出/优先级/无锁三种模式，在不同容量、消息大小和访问模式下测量：
+ *          - 每秒收发消息数（一次Send加一次Receive计为一条）
+ *          - 单次Send/Receive耗时的p50/p99（ns）
+ *          - 建队和收发过程中的堆分配次数与字节数
+ *          结果以CSV输出，修改队列实现前后各跑一次即可对比回归。
+ *
+ *          访问模式：
+ *          - steady：发一条收一条，队列始终接近空
+ *          - burst：发满整个队列再全部收完
+ *          - isr：模拟中断突发写入、主循环逐条读取，每次读取前随机写入0~3条
+ *
+ * 编译运行（在 msgqueue 目录下，--wrap用于统计malloc/free）：
+ *   gcc -O2 -Iexample/host -I. example/host/bench_msgqueue.c msgqueue.c \
+ *       -Wl,--wrap=malloc -Wl,--wrap=free -o bench_msgqueue
+ *   ./bench_msgqueue > msgqueue_bench.csv
+ */
+
+#include "msgqueue.h"
+#include <stdio.h>
+#include <time.h>
+
+uint32_t HAL_GetTick(void)
+{
+    return 0;
+}
+
+/* 每次测量收发的消息数 */
+#define BENCH_MESSAGES      200000UL
+
+/* 计时采样数（每次Send/Receive单独计时） */
+#define BENCH_SAMPLES       20000UL
+
+#define BENCH_MAX_MSG       512
+
+/* ---------------- 堆分配统计（链接时 --wrap=malloc --wrap=free） ---------------- */
+
+void *__real_malloc(size_t size);
+void __real_free(void *ptr);
+
+static unsigned long bench_allocs = 0;
+static unsigned long bench_alloc_bytes = 0;
+
+void *__wrap_malloc(size_t size)
+{
+    bench_allocs++;
+    bench_alloc_bytes += size;
+    return __real_malloc(size);
+}
+
+void __wrap_free(void *ptr)
+{
+    __real_free(ptr);
+}
+
+/* ---------------- 计时 ---------------- */
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* 排序后取百分位 */
+static uint32_t bench_percentile(uint32_t *samples, unsigned long n, unsigned pct)
+{
+    if (n == 0) {
+        return 0;
+    }
+    qsort(samples, n, sizeof(samples[0]), bench_cmp_u32);
+    return samples[(n - 1) * pct / 100];
+}
+
+/* ---------------- 测试配置 ---------------- */
+
+typedef enum {
+    BENCH_MODE_FIFO = 0,
+    BENCH_MODE_PRIORITY,
+    BENCH_MODE_SPSC,
+    BENCH_MODE_COUNT
+} BenchMode_t;
+
+typedef enum {
+    BENCH_PATTERN_STEADY = 0,
+    BENCH_PATTERN_BURST,
+    BENCH_PATTERN_ISR,
+    BENCH_PATTERN_COUNT
+} BenchPattern_t;
+
+static const char *const bench_mode_names[BENCH_MODE_COUNT] = {"fifo", "priority", "spsc"};
+static const char *const bench_pattern_names[BENCH_PATTERN_COUNT] = {"steady", "burst", "isr"};
+
+typedef struct {
+    MSGQUEUE_HandleTypeDef queue;
+    uint16_t msg_size;
+    uint32_t rng;               // 伪随机数状态（isr模式和优先级）
+    uint32_t *send_ns;          // 计时样本，NULL表示不计时
+    uint32_t *recv_ns;
+    unsigned long send_samples;
+    unsigned long recv_samples;
+} BenchCtx_t;
+
+static uint8_t bench_tx[BENCH_MAX_MSG];
+static uint8_t bench_rx[BENCH_MAX_MSG];
+static uint32_t bench_send_ns[BENCH_SAMPLES];
+static uint32_t bench_recv_ns[BENCH_SAMPLES];
+
+static uint32_t bench_rand(BenchCtx_t *ctx)
+{
+    ctx->rng = ctx->rng * 1664525U + 1013904223U;
+    return ctx->rng >> 16;
+}
+
+static void bench_send(BenchCtx_t *ctx)
+{
+    uint32_t priority = bench_rand(ctx) & 3U;
+
+    if (ctx->send_ns != NULL && ctx->send_samples < BENCH_SAMPLES) {
+        uint64_t t0 = bench_now_ns();
+        MSGQUEUE_Send(&ctx->queue, bench_tx, ctx->msg_size, priority);
+        ctx->send_ns[ctx->send_samples++] = (uint32_t)(bench_now_ns() - t0);
+    } else {
+        MSGQUEUE_Send(&ctx->queue, bench_tx, ctx->msg_size, priority);
+    }
+}
+
+static void bench_recv(BenchCtx_t *ctx)
+{
+    uint16_t size;
+
+    if (ctx->recv_ns != NULL && ctx->recv_samples < BENCH_SAMPLES) {
+        uint64_t t0 = bench_now_ns();
+        MSGQUEUE_Receive(&ctx->queue, bench_rx, sizeof(bench_rx), &size);
+        ctx->recv_ns[ctx->recv_samples++] = (uint32_t)(bench_now_ns() - t0);
+    } else {
+        MSGQUEUE_Receive(&ctx->queue, bench_rx, sizeof(bench_rx), &size);
+    }
+}
+
+/* 按访问模式收发messages条消息 */
+static void bench_pattern(BenchCtx_t *ctx, BenchPattern_t pattern, unsigned long messages)
+{
+    unsigned long sent = 0;
+    uint16_t capacity = ctx->queue.capacity;
+
+    switch (pattern) {
+    case BENCH_PATTERN_STEADY:
+        for (; sent < messages; sent++) {
+            bench_send(ctx);
+            bench_recv(ctx);
+        }
+        break;
+
+    case BENCH_PATTERN_BURST:
+        while (sent < messages) {
+            // 最后一轮只发剩余的消息，总数与其他模式一致
+            uint16_t burst = (messages - sent < capacity) ? (uint16_t)(messages - sent) : capacity;
+            for (uint16_t i = 0; i < burst; i++) {
+                bench_send(ctx);
+            }
+            for (uint16_t i = 0; i < burst; i++) {
+                bench_recv(ctx);
+            }
+            sent += burst;
+        }
+        break;
+
+    case BENCH_PATTERN_ISR:
+        while (sent < messages) {
+            uint32_t n = bench_rand(ctx) & 3U;
+            for (uint32_t i = 0; i < n && sent < messages && !MSGQUEUE_IsFull(&ctx->queue); i++) {
+                bench_send(ctx);
+                sent++;
+            }
+            if (!MSGQUEUE_IsEmpty(&ctx->queue)) {
+                bench_recv(ctx);
+            }
+        }
+        while (!MSGQUEUE_IsEmpty(&ctx->queue)) {
+            bench_recv(ctx);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+static int bench_setup(BenchCtx_t *ctx, BenchMode_t mode, uint16_t capacity, uint16_t msg_size)
+{
+    ctx->msg_size = msg_size;
+    ctx->rng = 12345;
+    ctx->send_ns = NULL;
+    ctx->recv_ns = NULL;
+    ctx->send_samples = 0;
+    ctx->recv_samples = 0;
+
+    if (MSGQUEUE_Init(&ctx->queue, capacity, msg_size) != MSGQUEUE_OK) {
+        return -1;
+    }
+    if (mode == BENCH_MODE_PRIORITY && MSGQUEUE_EnablePriority(&ctx->queue) != MSGQUEUE_OK) {
+        return -1;
+    }
+    if (mode == BENCH_MODE_SPSC && MSGQUEUE_EnableSPSC(&ctx->queue) != MSGQUEUE_OK) {
+        return -1;
+    }
+    return 0;
+}
+
+/* 运行一组配置并输出一行CSV */
+static void bench_run(BenchMode_t mode, BenchPattern_t pattern, uint16_t capacity, uint16_t msg_size)
+{
+    BenchCtx_t ctx;
+
+    // 建队+吞吐量测量，期间的堆分配都计入
+    unsigned long allocs_before = bench_allocs;
+    unsigned long bytes_before = bench_alloc_bytes;
+    if (bench_setup(&ctx, mode, capacity, msg_size) != 0) {
+        printf("%s,%s,%u,%u,setup failed\n", bench_mode_names[mode], bench_pattern_names[pattern],
+               capacity, msg_size);
+        return;
+    }
+    bench_pattern(&ctx, pattern, BENCH_MESSAGES / 10);  // 预热
+
+    uint64_t start = bench_now_ns();
+    bench_pattern(&ctx, pattern, BENCH_MESSAGES);
+    uint64_t elapsed = bench_now_ns() - start;
+    MSGQUEUE_Deinit(&ctx.queue);
+    unsigned long allocs = bench_allocs - allocs_before;
+    unsigned long alloc_bytes = bench_alloc_bytes - bytes_before;
+
+    // 单次操作延迟测量
+    bench_setup(&ctx, mode, capacity, msg_size);
+    ctx.send_ns = bench_send_ns;
+    ctx.recv_ns = bench_recv_ns;
+    bench_pattern(&ctx, pattern, BENCH_SAMPLES);
+    MSGQUEUE_Deinit(&ctx.queue);
+
+    double ops_per_s = (double)BENCH_MESSAGES * 1e9 / (double)(elapsed ? elapsed : 1);
+    printf("%s,%s,%u,%u,%.0f,%u,%u,%u,%u,%lu,%lu\n",
+           bench_mode_names[mode], bench_pattern_names[pattern], capacity, msg_size, ops_per_s,
+           bench_percentile(bench_send_ns, ctx.send_samples, 50),
+           bench_percentile(bench_send_ns, ctx.send_samples, 99),
+           bench_percentile(bench_recv_ns, ctx.recv_samples, 50),
+           bench_percentile(bench_recv_ns, ctx.recv_samples, 99),
+           allocs, alloc_bytes);
+}
+
+int main(void)
+{
+    static const uint16_t capacities[] = {8, 32, 128, 512, 1024};
+    static const uint16_t sizes[] = {4, 16, 64, 256, 512};
+
+    for (uint16_t i = 0; i < sizeof(bench_tx); i++) {
+        bench_tx[i] = (uint8_t)i;
+    }
+
+    printf("mode,pattern,capacity,msg_size,msgs_per_s,send_p50_ns,send_p99_ns,recv_p50_ns,recv_p99_ns,allocs,alloc_bytes\n");
+    for (int mode = 0; mode < BENCH_MODE_COUNT; mode++) {
+        for (int pattern = 0; pattern < BENCH_PATTERN_COUNT; pattern++) {
+            for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); c++) {
+                for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+                    bench_run((BenchMode_t)mode, (BenchPattern_t)pattern, capacities[c], sizes[s]);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,14 @@
+/**
+ * @file main.h
+ * @brief 主机端（Linux/PC）构建用的最小HAL替身
+ * @details 仅提供消息队列所需的HAL_GetTick()，由主机程序实现。
+ */
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include <stdint.h>
+
+/* 获取系统滴答值（ms） */
+uint32_t HAL_GetTick(void);
+
+#endif /* __MAIN_H */
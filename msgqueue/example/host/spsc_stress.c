@@ -0,0 +1,141 @@
+/**
+ * @file spsc_stress.c
+ * @brief 单生产者/单消费者无锁模式（MSGQUEUE_EnableSPSC）的主机端双线程压力测试
+ * @details 生产者线程模拟中断连续发送带序号的变长消息，消费者线程模拟主循环接收并校验
+ *          序号连续、长度和内容正确。双方都不加锁。任何错误都会使程序返回非0。
+ *
+ * 编译运行（在 msgqueue 目录下）：
+ *   gcc -O2 -pthread -Iexample/host -I. example/host/spsc_stress.c msgqueue.c -o spsc_stress
+ * 可加 -fsanitize=thread 用ThreadSanitizer检查数据竞争。
+ */
+
+#include "msgqueue.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+uint32_t HAL_GetTick(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
+}
+
+#define STRESS_MESSAGES     1000000UL   // 每轮消息数
+#define STRESS_SLEEP_EVERY  64          // 满/空退避时每多少次改为短暂休眠（单核主机上避免空转整个时间片）
+#define STRESS_MSG_MAX      32          // 最大消息长度
+
+static MSGQUEUE_HandleTypeDef stress_queue;
+static unsigned long producer_full = 0;
+
+/* 满/空时的退避：让出CPU，周期性地短暂休眠 */
+static void stress_backoff(unsigned long spins)
+{
+    if (spins % STRESS_SLEEP_EVERY == 0) {
+        struct timespec ts = {0, 1000};
+        nanosleep(&ts, NULL);
+    } else {
+        sched_yield();
+    }
+}
+
+/* 第seq条消息的长度：4字节序号 + 0~28字节填充 */
+static uint16_t stress_msg_size(uint32_t seq)
+{
+    return (uint16_t)(4U + seq % (STRESS_MSG_MAX - 3U));
+}
+
+static void* producer_main(void* arg)
+{
+    uint8_t msg[STRESS_MSG_MAX];
+    (void)arg;
+
+    for (uint32_t seq = 0; seq < STRESS_MESSAGES; seq++) {
+        uint16_t size = stress_msg_size(seq);
+        memcpy(msg, &seq, 4);
+        memset(msg + 4, (uint8_t)seq, size - 4U);
+        while (MSGQUEUE_Send(&stress_queue, msg, size, 0) == MSGQUEUE_FULL) {
+            producer_full++;
+            stress_backoff(producer_full);
+        }
+    }
+    return NULL;
+}
+
+static void* consumer_main(void* arg)
+{
+    uint8_t msg[STRESS_MSG_MAX];
+    uint16_t size = 0;
+    unsigned long empty = 0;
+    unsigned long* errors = (unsigned long*)arg;
+
+    for (uint32_t expected = 0; expected < STRESS_MESSAGES; ) {
+        if (MSGQUEUE_Pop(&stress_queue, msg, sizeof(msg), &size) != MSGQUEUE_OK) {
+            stress_backoff(++empty);
+            continue;
+        }
+
+        uint32_t seq;
+        memcpy(&seq, msg, 4);
+        uint8_t ok = (seq == expected) && (size == stress_msg_size(seq));
+        for (uint16_t i = 4; ok && i < size; i++) {
+            ok = (msg[i] == (uint8_t)seq);
+        }
+        if (!ok) {
+            (*errors)++;
+        }
+        expected++;
+    }
+    return NULL;
+}
+
+/* 以指定容量运行一轮，返回错误数 */
+static unsigned long stress_run(uint16_t capacity)
+{
+    pthread_t producer, consumer;
+    unsigned long errors = 0;
+    struct timespec start, end;
+
+    MSGQUEUE_Init(&stress_queue, capacity, STRESS_MSG_MAX);
+    if (MSGQUEUE_EnableSPSC(&stress_queue) != MSGQUEUE_OK) {
+        printf("capacity %u: EnableSPSC failed\n", capacity);
+        return 1;
+    }
+    producer_full = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&consumer, NULL, consumer_main, &errors);
+    pthread_create(&producer, NULL, producer_main, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%u,%lu,%.0f,%lu,%lu,%u\n", capacity, STRESS_MESSAGES, STRESS_MESSAGES / seconds,
+           producer_full, errors, MSGQUEUE_GetCount(&stress_queue));
+
+    MSGQUEUE_Deinit(&stress_queue);
+    return errors;
+}
+
+int main(void)
+{
+    static const uint16_t capacities[] = {2, 16, 256};
+    unsigned long errors = 0;
+
+    // 非2的幂容量应被拒绝
+    MSGQUEUE_Init(&stress_queue, 10, STRESS_MSG_MAX);
+    if (MSGQUEUE_EnableSPSC(&stress_queue) == MSGQUEUE_OK) {
+        errors++;
+    }
+    MSGQUEUE_Deinit(&stress_queue);
+
+    printf("capacity,messages,msgs_per_s,producer_full_spins,errors,left\n");
+    for (size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); i++) {
+        errors += stress_run(capacities[i]);
+    }
+
+    printf("%s\n", errors == 0 ? "PASS" : "FAIL");
+    return errors == 0 ? 0 : 1;
+}
@@ -1,11 +1,91 @@
 #include "msgqueue.h"
 
+#if MSGQUEUE_CONFIG_STATS
+#define MSGQUEUE_STAT_ADD(hqueue, field, n)     ((hqueue)->stats.field += (n))
+#else
+#define MSGQUEUE_STAT_ADD(hqueue, field, n)     ((void)0)
+#endif
+
+/* 已接受的消息未被接收就被丢弃：通知丢弃回调 */
+static inline void MSGQUEUE_NoteDropped(MSGQUEUE_HandleTypeDef *hqueue, const MSGQUEUE_Message *msg)
+{
+    if (hqueue->drop_hook != NULL) {
+        hqueue->drop_hook(hqueue, msg->data, msg->size);
+    }
+}
+
+/* 对队列中当前的全部消息调用丢弃回调（Clear/Deinit前） */
+static void MSGQUEUE_NoteDroppedAll(MSGQUEUE_HandleTypeDef *hqueue)
+{
+    if (hqueue->drop_hook == NULL) {
+        return;
+    }
+
+    if (hqueue->is_spsc) {
+        uint16_t rear = MSGQUEUE_LOAD_ACQUIRE(&hqueue->rear);
+        for (uint16_t pos = hqueue->front; pos != rear; pos++) {
+            MSGQUEUE_NoteDropped(hqueue, &hqueue->messages[pos & (hqueue->capacity - 1U)]);
+        }
+        return;
+    }
+    for (uint16_t i = 0; i < hqueue->count; i++) {
+        uint16_t slot = hqueue->is_priority ? hqueue->order[i] : (uint16_t)((hqueue->front + i) % hqueue->capacity);
+        MSGQUEUE_NoteDropped(hqueue, &hqueue->messages[slot]);
+    }
+}
+
+/* 在一块连续存储区上建立队列：消息数组在前，各消息数据区按对齐后的max_msg_size等间距排列在后 */
+static void MSGQUEUE_Setup(MSGQUEUE_HandleTypeDef *hqueue, uint16_t capacity, uint16_t max_msg_size,
+                           void *buffer, uint8_t is_static)
+{
+    // 初始化队列属性
+    hqueue->capacity = capacity;
+    hqueue->count = 0;
+    hqueue->front = 0;
+    hqueue->rear = 0;
+    hqueue->max_msg_size = max_msg_size;
+    hqueue->is_static = is_static;
+    hqueue->is_spsc = 0;
+    hqueue->is_priority = 0;
+    hqueue->next_seq = 0;
+    hqueue->is_reserved = 0;
+    hqueue->reserved_pos = 0;
+    hqueue->is_held = 0;
+    hqueue->held_slot = 0;
+    hqueue->policy = MSGQUEUE_POLICY_FULL;
+    hqueue->key_size = 0;
+#if MSGQUEUE_CONFIG_STATS
+    memset(&hqueue->stats, 0, sizeof(hqueue->stats));
+#endif
+    hqueue->drop_hook = NULL;
+    hqueue->mutex = NULL;
+    hqueue->user_data = NULL;
+
+    // 槽位索引数组紧跟消息数组；数据区起始和槽位步长都按MSGQUEUE_ALIGN_BYTES对齐，
+    // 第i条消息的数据区 = 数据区起始 + i * 步长，槽位之间没有分配器头部开销
+    uint32_t stride = MSGQUEUE_ALIGN(max_msg_size);
+    hqueue->messages = (MSGQUEUE_Message *)buffer;
+    hqueue->order = (uint16_t *)(hqueue->messages + capacity);
+    uint8_t *data_area = (uint8_t *)buffer + MSGQUEUE_ALIGN((uint32_t)capacity * (sizeof(MSGQUEUE_Message) + sizeof(uint16_t)));
+    for (uint16_t i = 0; i < capacity; i++) {
+        hqueue->order[i] = i;
+        hqueue->messages[i].data = data_area + (uint32_t)i * stride;
+        hqueue->messages[i].size = 0;
+        hqueue->messages[i].seq = 0;
+        hqueue->messages[i].priority = 0;
+        hqueue->messages[i].timestamp = 0;
+    }
+
+    hqueue->is_initialized = 1;
+}
+
 /**
  * @brief  初始化消息队列
  * @param  hqueue: 消息队列句柄
  * @param  capacity: 队列容量（最大消息数量）
  * @param  max_msg_size: 单个消息的最大大小（字节）
  * @retval MSGQUEUE_Status: 操作状态
+ * @note   消息数组与全部数据区一次性分配为一个连续内存块
  */
 MSGQUEUE_Status MSGQUEUE_Init(MSGQUEUE_HandleTypeDef *hqueue, uint16_t capacity, uint16_t max_msg_size)
 {
@@ -14,40 +94,290 @@ MSGQUEUE_Status MSGQUEUE_Init(MSGQUEUE_HandleTypeDef *hqueue, uint16_t capacity,
         return MSGQUEUE_ERROR;
     }
 
-    // 初始化队列属性
-    hqueue->capacity = capacity;
-    hqueue->count = 0;
+    // 分配存储区（布局与MSGQUEUE_InitStatic相同）
+    void *buffer = malloc(MSGQUEUE_STATIC_SIZE(capacity, max_msg_size));
+    if (buffer == NULL) {
+        hqueue->messages = NULL;
+        return MSGQUEUE_ERROR;
+    }
+
+    MSGQUEUE_Setup(hqueue, capacity, max_msg_size, buffer, 0);
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief  使用调用者提供的存储区初始化消息队列（不使用堆内存）
+ * @param  hqueue: 消息队列句柄
+ * @param  capacity: 队列容量（最大消息数量）
+ * @param  max_msg_size: 单个消息的最大大小（字节）
+ * @param  buffer: 存储区（需按MSGQUEUE_ALIGN_BYTES对齐）
+ * @param  buffer_size: 存储区大小
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_InitStatic(MSGQUEUE_HandleTypeDef *hqueue, uint16_t capacity, uint16_t max_msg_size,
+                                    void *buffer, uint32_t buffer_size)
+{
+    // 参数检查
+    if (hqueue == NULL || buffer == NULL || capacity == 0 || max_msg_size == 0 ||
+        buffer_size < MSGQUEUE_STATIC_SIZE(capacity, max_msg_size) ||
+        ((uintptr_t)buffer % MSGQUEUE_ALIGN_BYTES) != 0) {
+        return MSGQUEUE_ERROR;
+    }
+
+    MSGQUEUE_Setup(hqueue, capacity, max_msg_size, buffer, 1);
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief  将空队列切换为单生产者/单消费者无锁模式
+ * @param  hqueue: 已初始化的空消息队列句柄（容量须为2的幂，不超过32768）
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_EnableSPSC(MSGQUEUE_HandleTypeDef *hqueue)
+{
+    // 参数检查
+    if (hqueue == NULL || !hqueue->is_initialized || hqueue->count != 0 || hqueue->is_reserved || hqueue->is_priority ||
+        (hqueue->policy & ~MSGQUEUE_POLICY_REJECT_OVERSIZE) > MSGQUEUE_POLICY_DROP_NEWEST ||
+        hqueue->capacity > 32768U || (hqueue->capacity & (hqueue->capacity - 1U)) != 0) {
+        return MSGQUEUE_ERROR;
+    }
+
+    // front/rear改为自由递增的16位索引，槽位 = 索引 & (容量-1)，消息数 = rear - front
     hqueue->front = 0;
     hqueue->rear = 0;
-    hqueue->max_msg_size = max_msg_size;
-    hqueue->mutex = NULL;
-    hqueue->user_data = NULL;
+    hqueue->is_spsc = 1;
+
+    return MSGQUEUE_OK;
+}
 
-    // 分配消息数组内存
-    hqueue->messages = (MSGQUEUE_Message *)malloc(capacity * sizeof(MSGQUEUE_Message));
-    if (hqueue->messages == NULL) {
+/**
+ * @brief  将空队列切换为优先级模式
+ * @param  hqueue: 已初始化的空消息队列句柄（不能是无锁模式）
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_EnablePriority(MSGQUEUE_HandleTypeDef *hqueue)
+{
+    // 参数检查（同优先级按32位入队序号的回绕差值判断先后，消息在队列中停留期间的发送次数少于2^31即可）
+    if (hqueue == NULL || !hqueue->is_initialized || hqueue->count != 0 || hqueue->is_reserved || hqueue->is_spsc) {
         return MSGQUEUE_ERROR;
     }
 
-    // 初始化每个消息项
-    for (uint16_t i = 0; i < capacity; i++) {
-        hqueue->messages[i].data = (uint8_t *)malloc(max_msg_size);
-        if (hqueue->messages[i].data == NULL) {
-            // 清理已分配的资源
-            for (uint16_t j = 0; j < i; j++) {
-                free(hqueue->messages[j].data);
+    for (uint16_t i = 0; i < hqueue->capacity; i++) {
+        hqueue->order[i] = i;
+    }
+    hqueue->next_seq = 0;
+    hqueue->is_priority = 1;
+
+    return MSGQUEUE_OK;
+}
+
+/* 优先级模式：槽位a的消息是否应先于槽位b出队 */
+static uint8_t MSGQUEUE_Before(const MSGQUEUE_HandleTypeDef *hqueue, uint16_t a, uint16_t b)
+{
+    const MSGQUEUE_Message *ma = &hqueue->messages[a];
+    const MSGQUEUE_Message *mb = &hqueue->messages[b];
+
+    if (ma->priority != mb->priority) {
+        return (ma->priority > mb->priority) ? 1 : 0;
+    }
+    return ((int32_t)(ma->seq - mb->seq) < 0) ? 1 : 0;
+}
+
+/* 优先级模式：堆中pos处的槽位上浮 */
+static void MSGQUEUE_SiftUp(MSGQUEUE_HandleTypeDef *hqueue, uint16_t pos)
+{
+    uint16_t *order = hqueue->order;
+    uint16_t slot = order[pos];
+
+    while (pos > 0) {
+        uint16_t parent = (uint16_t)((pos - 1U) / 2U);
+        if (!MSGQUEUE_Before(hqueue, slot, order[parent])) {
+            break;
+        }
+        order[pos] = order[parent];
+        pos = parent;
+    }
+    order[pos] = slot;
+}
+
+/* 优先级模式：堆中pos处的槽位下沉 */
+static void MSGQUEUE_SiftDown(MSGQUEUE_HandleTypeDef *hqueue, uint16_t pos)
+{
+    uint16_t *order = hqueue->order;
+    uint16_t count = hqueue->count;
+    uint16_t slot = order[pos];
+
+    for (;;) {
+        uint32_t child = 2U * pos + 1U;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1U < count && MSGQUEUE_Before(hqueue, order[child + 1U], order[child])) {
+            child++;
+        }
+        if (!MSGQUEUE_Before(hqueue, order[child], slot)) {
+            break;
+        }
+        order[pos] = order[child];
+        pos = (uint16_t)child;
+    }
+    order[pos] = slot;
+}
+
+/* 优先级模式：删除堆中pos处的消息，其槽位放回空闲区（order[count]） */
+static void MSGQUEUE_RemoveAt(MSGQUEUE_HandleTypeDef *hqueue, uint16_t pos)
+{
+    uint16_t *order = hqueue->order;
+    uint16_t last = (uint16_t)(hqueue->count - 1U);
+    uint16_t slot = order[pos];
+
+    order[pos] = order[last];
+    order[last] = slot;
+    hqueue->count--;
+    if (pos < hqueue->count) {
+        MSGQUEUE_SiftDown(hqueue, pos);
+        MSGQUEUE_SiftUp(hqueue, pos);
+    }
+}
+
+/* 下一条发送的消息将写入的槽位（不检查是否已满） */
+static uint16_t MSGQUEUE_TailSlot(const MSGQUEUE_HandleTypeDef *hqueue)
+{
+    if (hqueue->is_spsc) {
+        return (uint16_t)(hqueue->rear & (hqueue->capacity - 1U));  // 只有生产者修改rear
+    }
+    if (hqueue->is_priority) {
+        return hqueue->order[hqueue->count];  // order[count..capacity)是空闲槽位，取第一个
+    }
+    return hqueue->rear;
+}
+
+/* 队列是否没有空闲槽位（无锁模式下以acquire语义读取front，之后才能复用消费者释放的槽位） */
+static uint8_t MSGQUEUE_NoFreeSlot(const MSGQUEUE_HandleTypeDef *hqueue)
+{
+    if (hqueue->is_spsc) {
+        return ((uint16_t)(hqueue->rear - MSGQUEUE_LOAD_ACQUIRE(&hqueue->front)) >= hqueue->capacity) ? 1 : 0;
+    }
+    return (hqueue->count >= hqueue->capacity) ? 1 : 0;
+}
+
+/* 统计：记录n条消息入队并更新高水位（无锁模式下只由生产者调用） */
+static void MSGQUEUE_NoteSent(MSGQUEUE_HandleTypeDef *hqueue, uint16_t n)
+{
+#if MSGQUEUE_CONFIG_STATS
+    uint16_t used = hqueue->is_spsc ? (uint16_t)(hqueue->rear - MSGQUEUE_LOAD_ACQUIRE(&hqueue->front))
+                                    : hqueue->count;
+    hqueue->stats.sent += n;
+    if (used > hqueue->stats.high_water) {
+        hqueue->stats.high_water = used;
+    }
+#else
+    (void)hqueue;
+    (void)n;
+#endif
+}
+
+/* 统计：记录槽位中的消息被接收，排队时间由入队时间戳计算（无锁模式下只由消费者调用） */
+static void MSGQUEUE_NoteReceived(MSGQUEUE_HandleTypeDef *hqueue, uint16_t slot, uint32_t now)
+{
+#if MSGQUEUE_CONFIG_STATS
+    uint32_t latency = now - hqueue->messages[slot].timestamp;
+    hqueue->stats.received++;
+    hqueue->stats.latency_sum += latency;
+    if (latency > hqueue->stats.latency_max) {
+        hqueue->stats.latency_max = latency;
+    }
+#else
+    (void)hqueue;
+    (void)slot;
+    (void)now;
+#endif
+}
+
+/* 填写槽位的消息属性并将其发布到队尾 */
+static void MSGQUEUE_Publish(MSGQUEUE_HandleTypeDef *hqueue, MSGQUEUE_Message *msg, uint16_t size, uint32_t priority)
+{
+    msg->size = size;
+    msg->priority = priority;
+    msg->timestamp = HAL_GetTick(); // 记录当前时间戳
+
+    if (hqueue->is_spsc) {
+        // 槽位内容先于新的rear对消费者可见
+        MSGQUEUE_STORE_RELEASE(&hqueue->rear, (uint16_t)(hqueue->rear + 1U));
+    } else if (hqueue->is_priority) {
+        msg->seq = hqueue->next_seq++;
+        hqueue->count++;
+        MSGQUEUE_SiftUp(hqueue, (uint16_t)(hqueue->count - 1U));
+    } else {
+        // 更新队尾索引
+        hqueue->rear = (hqueue->rear + 1) % hqueue->capacity;
+        hqueue->count++;
+    }
+    MSGQUEUE_NoteSent(hqueue, 1);
+}
+
+/* 挤出策略：删除一条最早（优先级模式下为优先级最低者中最早）的消息腾出槽位，成功返回1 */
+static uint8_t MSGQUEUE_DropOldest(MSGQUEUE_HandleTypeDef *hqueue, uint32_t priority)
+{
+    if (hqueue->is_priority) {
+        // 只在队列满时执行，线性查找优先级最低、同优先级中最早发送的消息
+        uint16_t victim = 0;
+        for (uint16_t pos = 1; pos < hqueue->count; pos++) {
+            const MSGQUEUE_Message *cur = &hqueue->messages[hqueue->order[pos]];
+            const MSGQUEUE_Message *min = &hqueue->messages[hqueue->order[victim]];
+            if (cur->priority < min->priority ||
+                (cur->priority == min->priority && (int32_t)(cur->seq - min->seq) < 0)) {
+                victim = pos;
             }
-            free(hqueue->messages);
-            hqueue->messages = NULL;
-            return MSGQUEUE_ERROR;
         }
-        hqueue->messages[i].size = 0;
-        hqueue->messages[i].priority = 0;
-        hqueue->messages[i].timestamp = 0;
+        // 新消息的优先级更低时丢弃新消息；接收方正在解析的消息不能挤出
+        uint16_t slot = hqueue->order[victim];
+        if (hqueue->messages[slot].priority > priority || (hqueue->is_held && hqueue->held_slot == slot)) {
+            return 0;
+        }
+        MSGQUEUE_NoteDropped(hqueue, &hqueue->messages[slot]);
+        MSGQUEUE_RemoveAt(hqueue, victim);
+    } else {
+        if (hqueue->is_held && hqueue->held_slot == hqueue->front) {
+            return 0;
+        }
+        MSGQUEUE_NoteDropped(hqueue, &hqueue->messages[hqueue->front]);
+        hqueue->front = (hqueue->front + 1) % hqueue->capacity;
+        hqueue->count--;
     }
 
-    hqueue->is_initialized = 1;
-    return MSGQUEUE_OK;
+    MSGQUEUE_STAT_ADD(hqueue, drops, 1);
+    return 1;
+}
+
+/* 合并策略：队列中已有相同键（消息开头key_size字节）的消息时覆盖其内容，成功返回1 */
+static uint8_t MSGQUEUE_Coalesce(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t *data, uint16_t size, uint32_t priority)
+{
+    if (size < hqueue->key_size) {
+        return 0;
+    }
+
+    for (uint16_t i = 0; i < hqueue->count; i++) {
+        uint16_t slot = hqueue->is_priority ? hqueue->order[i] : (uint16_t)((hqueue->front + i) % hqueue->capacity);
+        MSGQUEUE_Message *msg = &hqueue->messages[slot];
+        if (msg->size < hqueue->key_size || memcmp(msg->data, data, hqueue->key_size) != 0 ||
+            (hqueue->is_held && hqueue->held_slot == slot)) {
+            continue;
+        }
+
+        // 保留原消息的排队位置和时间戳，只更新内容和优先级；被覆盖的旧内容视为丢弃
+        MSGQUEUE_NoteDropped(hqueue, msg);
+        memcpy(msg->data, data, size);
+        msg->size = size;
+        if (hqueue->is_priority && msg->priority != priority) {
+            msg->priority = priority;
+            MSGQUEUE_SiftDown(hqueue, i);
+            MSGQUEUE_SiftUp(hqueue, i);
+        }
+        MSGQUEUE_STAT_ADD(hqueue, coalesced, 1);
+        return 1;
+    }
+    return 0;
 }
 
 /**
@@ -65,29 +395,145 @@ MSGQUEUE_Status MSGQUEUE_Send(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t *dat
         return MSGQUEUE_ERROR;
     }
 
-    // 检查队列是否已满
-    if (MSGQUEUE_IsFull(hqueue)) {
-        return MSGQUEUE_FULL;
-    }
-
     // 检查消息大小
     if (size > hqueue->max_msg_size) {
+        if (hqueue->policy & MSGQUEUE_POLICY_REJECT_OVERSIZE) {
+            MSGQUEUE_STAT_ADD(hqueue, oversize, 1);
+            return MSGQUEUE_OVERSIZE;
+        }
         size = hqueue->max_msg_size; // 截断消息
+        MSGQUEUE_STAT_ADD(hqueue, truncations, 1);
+    }
+
+    uint8_t policy = hqueue->policy & (uint8_t)~MSGQUEUE_POLICY_REJECT_OVERSIZE;
+    if (policy == MSGQUEUE_POLICY_COALESCE && MSGQUEUE_Coalesce(hqueue, data, size, priority)) {
+        return MSGQUEUE_OK;
+    }
+
+    // 检查队列是否已满（已预留的槽位尚未提交时也视为满）
+    if (hqueue->is_reserved) {
+        return MSGQUEUE_FULL;
+    }
+    if (MSGQUEUE_NoFreeSlot(hqueue) &&
+        !(policy == MSGQUEUE_POLICY_DROP_OLDEST && MSGQUEUE_DropOldest(hqueue, priority))) {
+        MSGQUEUE_STAT_ADD(hqueue, drops, 1);
+        if (policy != MSGQUEUE_POLICY_DROP_NEWEST && policy != MSGQUEUE_POLICY_DROP_OLDEST) {
+            return MSGQUEUE_FULL;
+        }
+        // 新消息被丢弃但Send仍返回成功，同样通知丢弃回调
+        if (hqueue->drop_hook != NULL) {
+            hqueue->drop_hook(hqueue, data, size);
+        }
+        return MSGQUEUE_OK;
     }
 
     // 复制消息数据到队列
-    memcpy(hqueue->messages[hqueue->rear].data, data, size);
-    hqueue->messages[hqueue->rear].size = size;
-    hqueue->messages[hqueue->rear].priority = priority;
-    hqueue->messages[hqueue->rear].timestamp = HAL_GetTick(); // 记录当前时间戳
+    MSGQUEUE_Message *msg = &hqueue->messages[MSGQUEUE_TailSlot(hqueue)];
+    memcpy(msg->data, data, size);
+    MSGQUEUE_Publish(hqueue, msg, size, priority);
+
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief  预留队尾槽位，由调用者直接向队列内存写入消息
+ * @param  hqueue: 消息队列句柄
+ * @param  buffer: 输出槽位数据区指针，可写入max_msg_size字节
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_Reserve(MSGQUEUE_HandleTypeDef *hqueue, uint8_t **buffer)
+{
+    // 参数检查（同一时间只能有一个未提交的预留）
+    if (hqueue == NULL || buffer == NULL || !hqueue->is_initialized || hqueue->is_reserved) {
+        return MSGQUEUE_ERROR;
+    }
 
-    // 更新队尾索引
-    hqueue->rear = (hqueue->rear + 1) % hqueue->capacity;
-    hqueue->count++;
+    if (MSGQUEUE_NoFreeSlot(hqueue) &&
+        !((hqueue->policy & (uint8_t)~MSGQUEUE_POLICY_REJECT_OVERSIZE) == MSGQUEUE_POLICY_DROP_OLDEST &&
+          MSGQUEUE_DropOldest(hqueue, 0xFFFFFFFFUL))) {
+        return MSGQUEUE_FULL;
+    }
+
+    // 优先级模式下记录槽位在空闲区中的位置：出队只会把空闲区起点前移，不会移动它
+    hqueue->reserved_pos = hqueue->count;
+    hqueue->is_reserved = 1;
+    *buffer = hqueue->messages[MSGQUEUE_TailSlot(hqueue)].data;
 
     return MSGQUEUE_OK;
 }
 
+/**
+ * @brief  提交MSGQUEUE_Reserve()预留的槽位，消息对接收方可见
+ * @param  hqueue: 消息队列句柄
+ * @param  size: 已写入的消息大小（字节）
+ * @param  priority: 消息优先级（可选）
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_Commit(MSGQUEUE_HandleTypeDef *hqueue, uint16_t size, uint32_t priority)
+{
+    // 参数检查
+    if (hqueue == NULL || !hqueue->is_initialized || !hqueue->is_reserved) {
+        return MSGQUEUE_ERROR;
+    }
+
+    if (size > hqueue->max_msg_size) {
+        size = hqueue->max_msg_size;
+        MSGQUEUE_STAT_ADD(hqueue, truncations, 1);
+    }
+
+    // 优先级模式：期间有消息出队时，把预留槽位换回空闲区起点
+    if (hqueue->is_priority && hqueue->reserved_pos != hqueue->count) {
+        uint16_t slot = hqueue->order[hqueue->reserved_pos];
+        hqueue->order[hqueue->reserved_pos] = hqueue->order[hqueue->count];
+        hqueue->order[hqueue->count] = slot;
+    }
+
+    hqueue->is_reserved = 0;
+    MSGQUEUE_Publish(hqueue, &hqueue->messages[MSGQUEUE_TailSlot(hqueue)], size, priority);
+
+    return MSGQUEUE_OK;
+}
+
+/* 取队首（优先级模式下为堆顶）消息所在槽位 */
+static MSGQUEUE_Status MSGQUEUE_HeadSlot(MSGQUEUE_HandleTypeDef *hqueue, uint16_t *slot)
+{
+    if (hqueue->is_spsc) {
+        // 以acquire语义读取rear，之后读到的槽位内容是完整的
+        if (MSGQUEUE_LOAD_ACQUIRE(&hqueue->rear) == hqueue->front) {
+            return MSGQUEUE_EMPTY;
+        }
+        *slot = (uint16_t)(hqueue->front & (hqueue->capacity - 1U));
+        return MSGQUEUE_OK;
+    }
+
+    if (hqueue->count == 0) {
+        return MSGQUEUE_EMPTY;
+    }
+    *slot = hqueue->is_priority ? hqueue->order[0] : hqueue->front;  // 堆顶即优先级最高、最早发送的消息
+    return MSGQUEUE_OK;
+}
+
+/* 删除队首消息（消息已被接收） */
+static void MSGQUEUE_RemoveHead(MSGQUEUE_HandleTypeDef *hqueue)
+{
+#if MSGQUEUE_CONFIG_STATS
+    uint16_t slot = 0;
+    MSGQUEUE_HeadSlot(hqueue, &slot);
+    MSGQUEUE_NoteReceived(hqueue, slot, HAL_GetTick());
+#endif
+
+    if (hqueue->is_spsc) {
+        // 槽位读完后以release语义发布front，生产者才能复用该槽位
+        MSGQUEUE_STORE_RELEASE(&hqueue->front, (uint16_t)(hqueue->front + 1U));
+    } else if (hqueue->is_priority) {
+        MSGQUEUE_RemoveAt(hqueue, 0);
+    } else {
+        // 更新队首索引，删除消息
+        hqueue->front = (hqueue->front + 1) % hqueue->capacity;
+        hqueue->count--;
+    }
+}
+
 /**
  * @brief  从消息队列接收消息（不删除）
  * @param  hqueue: 消息队列句柄
@@ -104,19 +550,20 @@ MSGQUEUE_Status MSGQUEUE_Peek(MSGQUEUE_HandleTypeDef *hqueue, uint8_t *data, uin
     }
 
     // 检查队列是否为空
-    if (MSGQUEUE_IsEmpty(hqueue)) {
+    uint16_t slot;
+    if (MSGQUEUE_HeadSlot(hqueue, &slot) != MSGQUEUE_OK) {
         return MSGQUEUE_EMPTY;
     }
 
     // 获取队首消息的实际大小
-    uint16_t msg_size = hqueue->messages[hqueue->front].size;
+    uint16_t msg_size = hqueue->messages[slot].size;
     if (received_size != NULL) {
         *received_size = msg_size;
     }
 
     // 复制数据到用户缓冲区，不超过缓冲区大小
     uint16_t copy_size = (size < msg_size) ? size : msg_size;
-    memcpy(data, hqueue->messages[hqueue->front].data, copy_size);
+    memcpy(data, hqueue->messages[slot].data, copy_size);
 
     return MSGQUEUE_OK;
 }
@@ -137,9 +584,67 @@ MSGQUEUE_Status MSGQUEUE_Pop(MSGQUEUE_HandleTypeDef *hqueue, uint8_t *data, uint
         return status;
     }
 
-    // 更新队首索引，删除消息
-    hqueue->front = (hqueue->front + 1) % hqueue->capacity;
-    hqueue->count--;
+    MSGQUEUE_RemoveHead(hqueue);
+
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief  取队首消息的数据区指针，由调用者直接在队列内存中解析（不复制、不删除）
+ * @param  hqueue: 消息队列句柄
+ * @param  data: 输出消息数据指针，MSGQUEUE_Release()之前有效
+ * @param  size: 输出消息大小（字节）
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_PeekPtr(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t **data, uint16_t *size)
+{
+    // 参数检查
+    if (hqueue == NULL || data == NULL || !hqueue->is_initialized) {
+        return MSGQUEUE_ERROR;
+    }
+
+    uint16_t slot;
+    if (MSGQUEUE_HeadSlot(hqueue, &slot) != MSGQUEUE_OK) {
+        return MSGQUEUE_EMPTY;
+    }
+
+    // 记录持有的槽位：优先级模式下释放前可能有更高优先级的消息排到它前面
+    hqueue->held_slot = slot;
+    hqueue->is_held = 1;
+    *data = hqueue->messages[slot].data;
+    if (size != NULL) {
+        *size = hqueue->messages[slot].size;
+    }
+
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief  删除MSGQUEUE_PeekPtr()取得的消息，槽位交还给发送方
+ * @param  hqueue: 消息队列句柄
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_Release(MSGQUEUE_HandleTypeDef *hqueue)
+{
+    // 参数检查
+    if (hqueue == NULL || !hqueue->is_initialized || !hqueue->is_held) {
+        return MSGQUEUE_ERROR;
+    }
+    hqueue->is_held = 0;
+
+    // 优先级模式：持有的消息已不在堆顶时按位置删除（少见，线性查找）
+    if (hqueue->is_priority && hqueue->order[0] != hqueue->held_slot) {
+        for (uint16_t pos = 1; pos < hqueue->count; pos++) {
+            if (hqueue->order[pos] == hqueue->held_slot) {
+                MSGQUEUE_NoteReceived(hqueue, hqueue->held_slot, HAL_GetTick());
+                MSGQUEUE_RemoveAt(hqueue, pos);
+                return MSGQUEUE_OK;
+            }
+        }
+        return MSGQUEUE_ERROR;
+    }
+
+    MSGQUEUE_RemoveHead(hqueue);
 
     return MSGQUEUE_OK;
 }
@@ -157,6 +662,218 @@ MSGQUEUE_Status MSGQUEUE_Receive(MSGQUEUE_HandleTypeDef *hqueue, uint8_t *data,
     return MSGQUEUE_Pop(hqueue, data, size, received_size);
 }
 
+/**
+ * @brief  批量发送消息
+ * @param  hqueue: 消息队列句柄
+ * @param  data: 连续存放的count条消息，每条msg_size字节
+ * @param  msg_size: 每条消息大小（字节）
+ * @param  count: 消息条数
+ * @param  priority: 消息优先级（可选）
+ * @param  sent: 输出实际发送的条数（可为NULL）
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_SendBatch(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t *data, uint16_t msg_size,
+                                   uint16_t count, uint32_t priority, uint16_t *sent)
+{
+    if (sent != NULL) {
+        *sent = 0;
+    }
+
+    // 参数检查
+    if (hqueue == NULL || data == NULL || !hqueue->is_initialized) {
+        return MSGQUEUE_ERROR;
+    }
+    if (hqueue->is_reserved) {
+        return MSGQUEUE_FULL;
+    }
+
+    // 设置了满处理策略或拒绝超长时逐条按Send的规则处理
+    if (hqueue->policy != MSGQUEUE_POLICY_FULL) {
+        MSGQUEUE_Status status = MSGQUEUE_OK;
+        uint16_t i;
+        for (i = 0; i < count; i++) {
+            status = MSGQUEUE_Send(hqueue, data + (uint32_t)i * msg_size, msg_size, priority);
+            if (status != MSGQUEUE_OK) {
+                break;
+            }
+        }
+        if (sent != NULL) {
+            *sent = i;
+        }
+        return status;
+    }
+
+    // 一次计算可发送的条数
+    uint16_t used = hqueue->is_spsc ? (uint16_t)(hqueue->rear - MSGQUEUE_LOAD_ACQUIRE(&hqueue->front))
+                                    : hqueue->count;
+    uint16_t space = (uint16_t)(hqueue->capacity - used);
+    uint16_t n = (count < space) ? count : space;
+    uint16_t size = (msg_size < hqueue->max_msg_size) ? msg_size : hqueue->max_msg_size;
+    uint32_t now = HAL_GetTick();
+
+    if (hqueue->is_priority) {
+        // 优先级模式：每条消息都要插入堆中
+        for (uint16_t i = 0; i < n; i++) {
+            MSGQUEUE_Message *msg = &hqueue->messages[hqueue->order[hqueue->count]];
+            memcpy(msg->data, data + (uint32_t)i * msg_size, size);
+            MSGQUEUE_Publish(hqueue, msg, size, priority);
+        }
+    } else {
+        // 先进先出/无锁模式：依次写入队尾之后的槽位，最后一次更新rear和count
+        uint16_t mask = (uint16_t)(hqueue->capacity - 1U);
+        uint16_t rear = hqueue->rear;
+        for (uint16_t i = 0; i < n; i++) {
+            MSGQUEUE_Message *msg = &hqueue->messages[hqueue->is_spsc ? (uint16_t)(rear & mask) : rear];
+            memcpy(msg->data, data + (uint32_t)i * msg_size, size);
+            msg->size = size;
+            msg->priority = priority;
+            msg->timestamp = now;
+            rear = hqueue->is_spsc ? (uint16_t)(rear + 1U) : (uint16_t)((rear + 1U) % hqueue->capacity);
+        }
+        if (hqueue->is_spsc) {
+            MSGQUEUE_STORE_RELEASE(&hqueue->rear, rear);
+        } else {
+            hqueue->rear = rear;
+            hqueue->count += n;
+        }
+        MSGQUEUE_NoteSent(hqueue, n);
+    }
+
+    if (msg_size > hqueue->max_msg_size) {
+        MSGQUEUE_STAT_ADD(hqueue, truncations, n);
+    }
+    MSGQUEUE_STAT_ADD(hqueue, drops, (uint32_t)(count - n));
+
+    if (sent != NULL) {
+        *sent = n;
+    }
+    return (n == count) ? MSGQUEUE_OK : MSGQUEUE_FULL;
+}
+
+/**
+ * @brief  批量接收并删除消息
+ * @param  hqueue: 消息队列句柄
+ * @param  data: 接收缓冲区，第i条消息存放在 data + i * msg_size
+ * @param  msg_size: 每条消息的缓冲区大小（字节）
+ * @param  max_count: 最多接收的条数
+ * @param  sizes: 输出每条消息的实际大小（可为NULL）
+ * @param  received: 输出实际接收的条数（可为NULL）
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_ReceiveBatch(MSGQUEUE_HandleTypeDef *hqueue, uint8_t *data, uint16_t msg_size,
+                                      uint16_t max_count, uint16_t *sizes, uint16_t *received)
+{
+    if (received != NULL) {
+        *received = 0;
+    }
+
+    // 参数检查
+    if (hqueue == NULL || data == NULL || !hqueue->is_initialized) {
+        return MSGQUEUE_ERROR;
+    }
+
+    // 一次计算可接收的条数
+    uint16_t avail = hqueue->is_spsc ? (uint16_t)(MSGQUEUE_LOAD_ACQUIRE(&hqueue->rear) - hqueue->front)
+                                     : hqueue->count;
+    uint16_t n = (max_count < avail) ? max_count : avail;
+    if (n == 0) {
+        return MSGQUEUE_EMPTY;
+    }
+
+    uint16_t mask = (uint16_t)(hqueue->capacity - 1U);
+    uint16_t front = hqueue->front;
+    uint32_t now = HAL_GetTick();
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t slot;
+        if (hqueue->is_priority) {
+            slot = hqueue->order[0];
+        } else {
+            slot = hqueue->is_spsc ? (uint16_t)(front & mask) : front;
+        }
+
+        const MSGQUEUE_Message *msg = &hqueue->messages[slot];
+        uint16_t copy_size = (msg_size < msg->size) ? msg_size : msg->size;
+        memcpy(data + (uint32_t)i * msg_size, msg->data, copy_size);
+        if (sizes != NULL) {
+            sizes[i] = msg->size;
+        }
+        MSGQUEUE_NoteReceived(hqueue, slot, now);
+
+        if (hqueue->is_priority) {
+            MSGQUEUE_RemoveAt(hqueue, 0);
+        } else {
+            front = hqueue->is_spsc ? (uint16_t)(front + 1U) : (uint16_t)((front + 1U) % hqueue->capacity);
+        }
+    }
+
+    // 最后一次更新front和count
+    if (hqueue->is_spsc) {
+        MSGQUEUE_STORE_RELEASE(&hqueue->front, front);
+    } else if (!hqueue->is_priority) {
+        hqueue->front = front;
+        hqueue->count -= n;
+    }
+
+    if (received != NULL) {
+        *received = n;
+    }
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief  依次对队列中的消息调用回调函数并删除，消息不复制
+ * @param  hqueue: 消息队列句柄
+ * @param  fn: 消息处理回调
+ * @param  max: 最多处理的条数，0表示处理调用时已有的全部消息
+ * @retval 处理的消息条数
+ */
+uint16_t MSGQUEUE_Drain(MSGQUEUE_HandleTypeDef *hqueue, MSGQUEUE_DrainCallback fn, uint16_t max)
+{
+    // 参数检查
+    if (hqueue == NULL || fn == NULL || !hqueue->is_initialized || hqueue->is_held) {
+        return 0;
+    }
+
+    uint16_t avail = hqueue->is_spsc ? (uint16_t)(MSGQUEUE_LOAD_ACQUIRE(&hqueue->rear) - hqueue->front)
+                                     : hqueue->count;
+    uint16_t n = (max != 0 && max < avail) ? max : avail;
+
+    if (hqueue->is_priority || (hqueue->policy & (uint8_t)~MSGQUEUE_POLICY_REJECT_OVERSIZE) > MSGQUEUE_POLICY_DROP_NEWEST) {
+        // 优先级模式或挤出/合并策略：回调中发送的消息可能排到前面或改动已有消息，按持有/释放逐条删除
+        for (uint16_t i = 0; i < n; i++) {
+            const uint8_t *data;
+            uint16_t size;
+            if (MSGQUEUE_PeekPtr(hqueue, &data, &size) != MSGQUEUE_OK) {
+                return i;
+            }
+            fn(hqueue, data, size);
+            MSGQUEUE_Release(hqueue);
+        }
+        return n;
+    }
+
+    // 先进先出/无锁模式：回调期间槽位仍计入count，发送方不会覆盖；最后一次更新front和count
+    uint16_t mask = (uint16_t)(hqueue->capacity - 1U);
+    uint16_t front = hqueue->front;
+    uint32_t now = HAL_GetTick();
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t slot = hqueue->is_spsc ? (uint16_t)(front & mask) : front;
+        const MSGQUEUE_Message *msg = &hqueue->messages[slot];
+        MSGQUEUE_NoteReceived(hqueue, slot, now);
+        fn(hqueue, msg->data, msg->size);
+        front = hqueue->is_spsc ? (uint16_t)(front + 1U) : (uint16_t)((front + 1U) % hqueue->capacity);
+    }
+
+    if (hqueue->is_spsc) {
+        MSGQUEUE_STORE_RELEASE(&hqueue->front, front);
+    } else {
+        hqueue->front = front;
+        hqueue->count -= n;
+    }
+
+    return n;
+}
+
 /**
  * @brief  清空消息队列
  * @param  hqueue: 消息队列句柄
@@ -169,10 +886,19 @@ MSGQUEUE_Status MSGQUEUE_Clear(MSGQUEUE_HandleTypeDef *hqueue)
         return MSGQUEUE_ERROR;
     }
 
-    // 重置队列状态
+    // 清空后不再持有任何消息
+    MSGQUEUE_NoteDroppedAll(hqueue);
+    hqueue->is_held = 0;
+
+    // 无锁模式下只能由消费者清空：丢弃当前已发布的全部消息
+    if (hqueue->is_spsc) {
+        MSGQUEUE_STORE_RELEASE(&hqueue->front, MSGQUEUE_LOAD_ACQUIRE(&hqueue->rear));
+        return MSGQUEUE_OK;
+    }
+
+    // 重置队列状态（rear保持不变，未提交的预留槽位仍然有效）
     hqueue->count = 0;
-    hqueue->front = 0;
-    hqueue->rear = 0;
+    hqueue->front = hqueue->rear;
 
     return MSGQUEUE_OK;
 }
@@ -189,19 +915,14 @@ MSGQUEUE_Status MSGQUEUE_Deinit(MSGQUEUE_HandleTypeDef *hqueue)
         return MSGQUEUE_ERROR;
     }
 
-    // 释放每个消息的数据缓冲区
-    for (uint16_t i = 0; i < hqueue->capacity; i++) {
-        if (hqueue->messages[i].data != NULL) {
-            free(hqueue->messages[i].data);
-            hqueue->messages[i].data = NULL;
-        }
-    }
+    MSGQUEUE_NoteDroppedAll(hqueue);
 
-    // 释放消息数组
-    if (hqueue->messages != NULL) {
+    // 消息数组与数据区是同一个内存块，一次释放
+    if (!hqueue->is_static && hqueue->messages != NULL) {
         free(hqueue->messages);
-        hqueue->messages = NULL;
     }
+    hqueue->messages = NULL;
+    hqueue->order = NULL;
 
     // 重置队列属性
     hqueue->is_initialized = 0;
@@ -210,12 +931,113 @@ MSGQUEUE_Status MSGQUEUE_Deinit(MSGQUEUE_HandleTypeDef *hqueue)
     hqueue->front = 0;
     hqueue->rear = 0;
     hqueue->max_msg_size = 0;
+    hqueue->is_static = 0;
+    hqueue->is_spsc = 0;
+    hqueue->is_priority = 0;
+    hqueue->next_seq = 0;
+    hqueue->is_reserved = 0;
+    hqueue->reserved_pos = 0;
+    hqueue->is_held = 0;
+    hqueue->held_slot = 0;
+    hqueue->policy = MSGQUEUE_POLICY_FULL;
+    hqueue->key_size = 0;
+#if MSGQUEUE_CONFIG_STATS
+    memset(&hqueue->stats, 0, sizeof(hqueue->stats));
+#endif
+    hqueue->drop_hook = NULL;
     hqueue->mutex = NULL;
     hqueue->user_data = NULL;
 
     return MSGQUEUE_OK;
 }
 
+/**
+ * @brief  设置队列满处理策略
+ * @param  hqueue: 消息队列句柄
+ * @param  policy: MSGQUEUE_Policy，可按位或MSGQUEUE_POLICY_REJECT_OVERSIZE
+ * @param  key_size: 合并策略下消息开头作为键的字节数
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_SetPolicy(MSGQUEUE_HandleTypeDef *hqueue, uint8_t policy, uint8_t key_size)
+{
+    uint8_t overflow = policy & (uint8_t)~MSGQUEUE_POLICY_REJECT_OVERSIZE;
+
+    // 参数检查：合并策略需要键长度；无锁模式下发送方不能改动已发布的消息
+    if (hqueue == NULL || !hqueue->is_initialized || overflow > MSGQUEUE_POLICY_COALESCE ||
+        (overflow == MSGQUEUE_POLICY_COALESCE && (key_size == 0 || key_size > hqueue->max_msg_size)) ||
+        (hqueue->is_spsc && overflow > MSGQUEUE_POLICY_DROP_NEWEST)) {
+        return MSGQUEUE_ERROR;
+    }
+
+    hqueue->policy = policy;
+    hqueue->key_size = (overflow == MSGQUEUE_POLICY_COALESCE) ? key_size : 0;
+
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief  设置丢弃回调
+ * @param  hqueue: 消息队列句柄
+ * @param  hook: 丢弃回调，NULL表示取消
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_SetDropHook(MSGQUEUE_HandleTypeDef *hqueue, MSGQUEUE_DropHook hook)
+{
+    // 参数检查
+    if (hqueue == NULL || !hqueue->is_initialized) {
+        return MSGQUEUE_ERROR;
+    }
+
+    hqueue->drop_hook = hook;
+
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief  获取队列统计信息
+ * @param  hqueue: 消息队列句柄
+ * @param  stats: 输出统计信息
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_GetStats(MSGQUEUE_HandleTypeDef *hqueue, MSGQUEUE_Stats *stats)
+{
+#if MSGQUEUE_CONFIG_STATS
+    // 参数检查
+    if (hqueue == NULL || stats == NULL || !hqueue->is_initialized) {
+        return MSGQUEUE_ERROR;
+    }
+
+    *stats = hqueue->stats;
+    stats->latency_avg = (stats->received != 0) ? stats->latency_sum / stats->received : 0;
+
+    return MSGQUEUE_OK;
+#else
+    (void)hqueue;
+    (void)stats;
+    return MSGQUEUE_ERROR;
+#endif
+}
+
+/**
+ * @brief  清零队列统计信息（高水位重置为当前消息数）
+ * @param  hqueue: 消息队列句柄
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_ResetStats(MSGQUEUE_HandleTypeDef *hqueue)
+{
+    // 参数检查
+    if (hqueue == NULL || !hqueue->is_initialized) {
+        return MSGQUEUE_ERROR;
+    }
+
+#if MSGQUEUE_CONFIG_STATS
+    memset(&hqueue->stats, 0, sizeof(hqueue->stats));
+    hqueue->stats.high_water = MSGQUEUE_GetCount(hqueue);
+#endif
+
+    return MSGQUEUE_OK;
+}
+
 /**
  * @brief  获取消息队列中的消息数量
  * @param  hqueue: 消息队列句柄
@@ -226,6 +1048,9 @@ uint16_t MSGQUEUE_GetCount(MSGQUEUE_HandleTypeDef *hqueue)
     if (hqueue == NULL || !hqueue->is_initialized) {
         return 0;
     }
+    if (hqueue->is_spsc) {
+        return (uint16_t)(MSGQUEUE_LOAD_ACQUIRE(&hqueue->rear) - MSGQUEUE_LOAD_ACQUIRE(&hqueue->front));
+    }
     return hqueue->count;
 }
 
@@ -239,6 +1064,9 @@ uint8_t MSGQUEUE_IsEmpty(MSGQUEUE_HandleTypeDef *hqueue)
     if (hqueue == NULL || !hqueue->is_initialized) {
         return 1;
     }
+    if (hqueue->is_spsc) {
+        return (MSGQUEUE_GetCount(hqueue) == 0) ? 1 : 0;
+    }
     return (hqueue->count == 0) ? 1 : 0;
 }
 
@@ -252,6 +1080,9 @@ uint8_t MSGQUEUE_IsFull(MSGQUEUE_HandleTypeDef *hqueue)
     if (hqueue == NULL || !hqueue->is_initialized) {
         return 0;
     }
+    if (hqueue->is_spsc) {
+        return (MSGQUEUE_GetCount(hqueue) >= hqueue->capacity) ? 1 : 0;
+    }
     return (hqueue->count >= hqueue->capacity) ? 1 : 0;
 }
 
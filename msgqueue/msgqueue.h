@@ -2,10 +2,45 @@
 #define __MSGQUEUE_H
 
 #include "main.h"
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* 1=每个队列记录收发统计（高水位、丢弃、截断、排队时延），见MSGQUEUE_GetStats() */
+#ifndef MSGQUEUE_CONFIG_STATS
+#define MSGQUEUE_CONFIG_STATS       1
+#endif
+
+/* 槽位数据区的对齐单位（平台最大基本对齐），保证槽位内可以直接存放任意类型的结构体 */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+typedef max_align_t MSGQUEUE_AlignUnit_t;
+#define MSGQUEUE_ALIGN_BYTES        ((uint32_t)_Alignof(max_align_t))
+#else
+typedef union {
+    void *p;
+    uint64_t u;
+    double d;
+} MSGQUEUE_AlignUnit_t;
+#define MSGQUEUE_ALIGN_BYTES        ((uint32_t)sizeof(MSGQUEUE_AlignUnit_t))
+#endif
+#define MSGQUEUE_ALIGN(size)        (((uint32_t)(size) + MSGQUEUE_ALIGN_BYTES - 1U) / MSGQUEUE_ALIGN_BYTES * MSGQUEUE_ALIGN_BYTES)
+
+/* 单生产者/单消费者无锁模式的内存屏障与索引原子读写 */
+#if defined(__GNUC__)
+#define MSGQUEUE_LOAD_ACQUIRE(ptr)          __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define MSGQUEUE_STORE_RELEASE(ptr, val)    __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#else
+#define MSGQUEUE_LOAD_ACQUIRE(ptr)          MSGQUEUE_LoadAcquire16(ptr)
+#define MSGQUEUE_STORE_RELEASE(ptr, val)    do { __DMB(); *(volatile uint16_t *)(ptr) = (val); } while (0)
+static inline uint16_t MSGQUEUE_LoadAcquire16(const uint16_t *ptr)
+{
+    uint16_t val = *(const volatile uint16_t *)ptr;
+    __DMB();
+    return val;
+}
+#endif
+
 /**
  * 消息队列状态枚举
  */
@@ -13,15 +48,46 @@ typedef enum {
     MSGQUEUE_OK = 0,       // 操作成功
     MSGQUEUE_EMPTY,        // 队列为空
     MSGQUEUE_FULL,         // 队列已满
-    MSGQUEUE_ERROR         // 一般错误
+    MSGQUEUE_ERROR,        // 一般错误
+    MSGQUEUE_OVERSIZE      // 消息超过max_msg_size且队列设置了MSGQUEUE_POLICY_REJECT_OVERSIZE
 } MSGQUEUE_Status;
 
+/**
+ * 队列满时的处理策略
+ */
+typedef enum {
+    MSGQUEUE_POLICY_FULL = 0,      // 返回MSGQUEUE_FULL，由发送方处理（默认）
+    MSGQUEUE_POLICY_DROP_NEWEST,   // 丢弃新消息，Send返回MSGQUEUE_OK
+    MSGQUEUE_POLICY_DROP_OLDEST,   // 挤出最早的消息（优先级模式下为优先级最低者中最早的，新消息优先级更低时丢弃新消息）
+    MSGQUEUE_POLICY_COALESCE       // 队列中已有相同键的消息时覆盖其内容，否则按MSGQUEUE_POLICY_FULL处理
+} MSGQUEUE_Policy;
+
+/* 可与上述策略按位或：超长消息返回MSGQUEUE_OVERSIZE，而不是截断到max_msg_size */
+#define MSGQUEUE_POLICY_REJECT_OVERSIZE     0x80U
+
+/**
+ * 队列统计信息
+ */
+typedef struct {
+    uint32_t sent;                 // 入队消息数
+    uint32_t received;             // 被接收的消息数
+    uint32_t drops;                // 因队列满被丢弃的消息数（含被挤出的旧消息）
+    uint32_t truncations;          // 被截断的消息数
+    uint32_t oversize;             // 因超长被拒绝的消息数
+    uint32_t coalesced;            // 合并到已有消息的次数
+    uint32_t latency_sum;          // 被接收消息的排队时间总和（ms）
+    uint32_t latency_max;          // 最大排队时间（ms）
+    uint32_t latency_avg;          // 平均排队时间（ms），由MSGQUEUE_GetStats()计算
+    uint16_t high_water;           // 消息数量高水位
+} MSGQUEUE_Stats;
+
 /**
  * 消息结构体定义
  */
 typedef struct {
     uint8_t *data;         // 消息数据指针
     uint16_t size;         // 消息大小
+    uint32_t seq;          // 入队序号（优先级模式下同优先级按此保持先进先出，按32位回绕比较）
     uint32_t priority;     // 消息优先级（可选）
     uint32_t timestamp;    // 消息时间戳（可选）
 } MSGQUEUE_Message;
@@ -29,18 +95,44 @@ typedef struct {
 /**
  * 消息队列结构体定义
  */
-typedef struct {
+typedef struct MSGQUEUE_Handle {
     MSGQUEUE_Message *messages;    // 消息数组
+    uint16_t *order;               // 槽位索引数组（优先级模式下前count项为二叉堆，其余为空闲槽位）
     uint16_t capacity;             // 队列容量
     uint16_t count;                // 当前消息数量
     uint16_t front;                // 队首索引
     uint16_t rear;                 // 队尾索引
     uint16_t max_msg_size;         // 最大消息大小
+    uint16_t reserved_pos;         // MSGQUEUE_Reserve()预留槽位在order中的位置（优先级模式）
+    uint16_t held_slot;            // MSGQUEUE_PeekPtr()持有的槽位
+    uint32_t next_seq;             // 下一条消息的入队序号
     uint8_t is_initialized;        // 初始化标志
+    uint8_t is_static;             // 存储区由调用者提供（销毁时不释放）
+    uint8_t is_spsc;               // 单生产者/单消费者无锁模式（front/rear为自由递增索引）
+    uint8_t is_priority;           // 优先级模式（按优先级出队，同优先级先进先出）
+    uint8_t is_reserved;           // 发送方有未提交的预留槽位
+    uint8_t is_held;               // 接收方持有未释放的队首消息
+    uint8_t policy;                // 队列满处理策略（MSGQUEUE_Policy | MSGQUEUE_POLICY_REJECT_OVERSIZE）
+    uint8_t key_size;              // 合并策略下消息开头作为键的字节数
+#if MSGQUEUE_CONFIG_STATS
+    MSGQUEUE_Stats stats;          // 统计信息
+#endif
+    void (*drop_hook)(struct MSGQUEUE_Handle *hqueue, const uint8_t *data, uint16_t size); // 丢弃回调（见MSGQUEUE_SetDropHook）
     void *mutex;                   // 互斥锁（预留，可用于RTOS集成）
     void *user_data;               // 用户自定义数据
 } MSGQUEUE_HandleTypeDef;
 
+/**
+ * MSGQUEUE_Drain() 的消息处理回调，data指向队列内的消息数据（仅在回调期间有效）
+ */
+typedef void (*MSGQUEUE_DrainCallback)(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t *data, uint16_t size);
+
+/**
+ * 丢弃回调：消息被挤出、合并覆盖、DROP_*策略下丢弃新消息或被Clear/Deinit清除时调用，
+ * data指向被丢弃的消息数据（仅在回调期间有效）。消息中保存的是指针/句柄时可在此释放其引用
+ */
+typedef void (*MSGQUEUE_DropHook)(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t *data, uint16_t size);
+
 /**
  * @brief  初始化消息队列
  * @param  hqueue: 消息队列句柄
@@ -50,6 +142,42 @@ typedef struct {
  */
 MSGQUEUE_Status MSGQUEUE_Init(MSGQUEUE_HandleTypeDef *hqueue, uint16_t capacity, uint16_t max_msg_size);
 
+/* MSGQUEUE_InitStatic() 所需存储区大小（字节），也是MSGQUEUE_Init()一次性分配的大小，
+   含数据区起始和每个槽位按MSGQUEUE_ALIGN_BYTES对齐的填充 */
+#define MSGQUEUE_STATIC_SIZE(capacity, max_msg_size) \
+    (MSGQUEUE_ALIGN((uint32_t)(capacity) * (sizeof(MSGQUEUE_Message) + sizeof(uint16_t))) + \
+     (uint32_t)(capacity) * MSGQUEUE_ALIGN(max_msg_size))
+
+/**
+ * @brief  使用调用者提供的存储区初始化消息队列（不使用堆内存）
+ * @param  hqueue: 消息队列句柄
+ * @param  capacity: 队列容量（最大消息数量）
+ * @param  max_msg_size: 单个消息的最大大小（字节）
+ * @param  buffer: 存储区（需按MSGQUEUE_ALIGN_BYTES对齐，未对齐时返回MSGQUEUE_ERROR），可用MSGQUEUE_AlignUnit_t静态数组
+ * @param  buffer_size: 存储区大小，不小于MSGQUEUE_STATIC_SIZE(capacity, max_msg_size)
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_InitStatic(MSGQUEUE_HandleTypeDef *hqueue, uint16_t capacity, uint16_t max_msg_size,
+                                    void *buffer, uint32_t buffer_size);
+
+/**
+ * @brief  将空队列切换为单生产者/单消费者无锁模式
+ * @param  hqueue: 已初始化的空消息队列句柄（容量须为2的幂，不超过32768）
+ * @retval MSGQUEUE_Status: 操作状态
+ * @note   该模式下只能有一个发送方（如一个中断）和一个接收方（如主循环），
+ *         双方都不需要关中断；Send只修改rear，Pop/Clear只修改front
+ */
+MSGQUEUE_Status MSGQUEUE_EnableSPSC(MSGQUEUE_HandleTypeDef *hqueue);
+
+/**
+ * @brief  将空队列切换为优先级模式
+ * @param  hqueue: 已初始化的空消息队列句柄（不能是无锁模式）
+ * @retval MSGQUEUE_Status: 操作状态
+ * @note   该模式下Receive/Pop/Peek总是取优先级数值最大的消息，同优先级按发送顺序；
+ *         发送和接收均为O(log n)
+ */
+MSGQUEUE_Status MSGQUEUE_EnablePriority(MSGQUEUE_HandleTypeDef *hqueue);
+
 /**
  * @brief  向消息队列发送消息
  * @param  hqueue: 消息队列句柄
@@ -60,6 +188,41 @@ MSGQUEUE_Status MSGQUEUE_Init(MSGQUEUE_HandleTypeDef *hqueue, uint16_t capacity,
  */
 MSGQUEUE_Status MSGQUEUE_Send(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t *data, uint16_t size, uint32_t priority);
 
+/**
+ * @brief  预留队尾槽位，由调用者直接向队列内存写入消息（零拷贝发送）
+ * @param  hqueue: 消息队列句柄
+ * @param  buffer: 输出槽位数据区指针，可写入max_msg_size字节；按MSGQUEUE_ALIGN_BYTES对齐，可直接按结构体写入
+ * @retval MSGQUEUE_Status: 操作状态
+ * @note   预留后须调用MSGQUEUE_Commit()提交；提交前其他发送方的Send返回MSGQUEUE_FULL
+ */
+MSGQUEUE_Status MSGQUEUE_Reserve(MSGQUEUE_HandleTypeDef *hqueue, uint8_t **buffer);
+
+/**
+ * @brief  提交MSGQUEUE_Reserve()预留的槽位，消息对接收方可见
+ * @param  hqueue: 消息队列句柄
+ * @param  size: 已写入的消息大小（字节），超过max_msg_size时截断
+ * @param  priority: 消息优先级（可选）
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_Commit(MSGQUEUE_HandleTypeDef *hqueue, uint16_t size, uint32_t priority);
+
+/**
+ * @brief  取队首消息的数据区指针，由调用者直接在队列内存中解析（零拷贝接收，不删除）
+ * @param  hqueue: 消息队列句柄
+ * @param  data: 输出消息数据指针，MSGQUEUE_Release()之前有效；按MSGQUEUE_ALIGN_BYTES对齐，可直接按结构体读取
+ * @param  size: 输出消息大小（字节）
+ * @retval MSGQUEUE_Status: 操作状态
+ * @note   处理完后须调用MSGQUEUE_Release()；期间不要调用Pop/Receive
+ */
+MSGQUEUE_Status MSGQUEUE_PeekPtr(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t **data, uint16_t *size);
+
+/**
+ * @brief  删除MSGQUEUE_PeekPtr()取得的消息，槽位交还给发送方
+ * @param  hqueue: 消息队列句柄
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_Release(MSGQUEUE_HandleTypeDef *hqueue);
+
 /**
  * @brief  从消息队列接收消息
  * @param  hqueue: 消息队列句柄
@@ -90,6 +253,42 @@ MSGQUEUE_Status MSGQUEUE_Pop(MSGQUEUE_HandleTypeDef *hqueue, uint8_t *data, uint
  */
 MSGQUEUE_Status MSGQUEUE_Peek(MSGQUEUE_HandleTypeDef *hqueue, uint8_t *data, uint16_t size, uint16_t *received_size);
 
+/**
+ * @brief  批量发送消息
+ * @param  hqueue: 消息队列句柄
+ * @param  data: 连续存放的count条消息，每条msg_size字节
+ * @param  msg_size: 每条消息大小（字节）
+ * @param  count: 消息条数
+ * @param  priority: 消息优先级（可选）
+ * @param  sent: 输出实际发送的条数（可为NULL）
+ * @retval MSGQUEUE_Status: 全部发送返回MSGQUEUE_OK，空闲槽位不足时发送能放下的部分并返回MSGQUEUE_FULL
+ */
+MSGQUEUE_Status MSGQUEUE_SendBatch(MSGQUEUE_HandleTypeDef *hqueue, const uint8_t *data, uint16_t msg_size,
+                                   uint16_t count, uint32_t priority, uint16_t *sent);
+
+/**
+ * @brief  批量接收并删除消息
+ * @param  hqueue: 消息队列句柄
+ * @param  data: 接收缓冲区，第i条消息存放在 data + i * msg_size
+ * @param  msg_size: 每条消息的缓冲区大小（字节），超出部分截断
+ * @param  max_count: 最多接收的条数
+ * @param  sizes: 输出每条消息的实际大小（可为NULL）
+ * @param  received: 输出实际接收的条数（可为NULL）
+ * @retval MSGQUEUE_Status: 至少接收一条返回MSGQUEUE_OK，队列为空返回MSGQUEUE_EMPTY
+ */
+MSGQUEUE_Status MSGQUEUE_ReceiveBatch(MSGQUEUE_HandleTypeDef *hqueue, uint8_t *data, uint16_t msg_size,
+                                      uint16_t max_count, uint16_t *sizes, uint16_t *received);
+
+/**
+ * @brief  依次对队列中的消息调用回调函数并删除，消息不复制
+ * @param  hqueue: 消息队列句柄
+ * @param  fn: 消息处理回调
+ * @param  max: 最多处理的条数，0表示处理调用时已有的全部消息
+ * @retval 处理的消息条数
+ * @note   回调中可以向本队列发送消息，但不要对本队列调用Pop/Receive/Clear
+ */
+uint16_t MSGQUEUE_Drain(MSGQUEUE_HandleTypeDef *hqueue, MSGQUEUE_DrainCallback fn, uint16_t max);
+
 /**
  * @brief  清空消息队列
  * @param  hqueue: 消息队列句柄
@@ -104,6 +303,40 @@ MSGQUEUE_Status MSGQUEUE_Clear(MSGQUEUE_HandleTypeDef *hqueue);
  */
 MSGQUEUE_Status MSGQUEUE_Deinit(MSGQUEUE_HandleTypeDef *hqueue);
 
+/**
+ * @brief  设置队列满处理策略
+ * @param  hqueue: 消息队列句柄
+ * @param  policy: MSGQUEUE_Policy，可按位或MSGQUEUE_POLICY_REJECT_OVERSIZE
+ * @param  key_size: 合并策略下消息开头作为键的字节数（其他策略填0）
+ * @retval MSGQUEUE_Status: 操作状态
+ * @note   无锁模式下发送方不能删除或改写已发布的消息，只支持FULL/DROP_NEWEST
+ */
+MSGQUEUE_Status MSGQUEUE_SetPolicy(MSGQUEUE_HandleTypeDef *hqueue, uint8_t policy, uint8_t key_size);
+
+/**
+ * @brief  设置丢弃回调
+ * @param  hqueue: 消息队列句柄
+ * @param  hook: 丢弃回调，NULL表示取消
+ * @retval MSGQUEUE_Status: 操作状态
+ * @note   回调在发送方/清空方的上下文中调用，不要在回调中操作本队列
+ */
+MSGQUEUE_Status MSGQUEUE_SetDropHook(MSGQUEUE_HandleTypeDef *hqueue, MSGQUEUE_DropHook hook);
+
+/**
+ * @brief  获取队列统计信息
+ * @param  hqueue: 消息队列句柄
+ * @param  stats: 输出统计信息
+ * @retval MSGQUEUE_Status: 操作状态（MSGQUEUE_CONFIG_STATS为0时返回MSGQUEUE_ERROR）
+ */
+MSGQUEUE_Status MSGQUEUE_GetStats(MSGQUEUE_HandleTypeDef *hqueue, MSGQUEUE_Stats *stats);
+
+/**
+ * @brief  清零队列统计信息（高水位重置为当前消息数）
+ * @param  hqueue: 消息队列句柄
+ * @retval MSGQUEUE_Status: 操作状态
+ */
+MSGQUEUE_Status MSGQUEUE_ResetStats(MSGQUEUE_HandleTypeDef *hqueue);
+
 /**
  * @brief  获取消息队列中的消息数量
  * @param  hqueue: 消息队列句柄
@@ -0,0 +1,147 @@
+#include "taskmanager.h"
+#include "main.h"
+#include "usart.h"
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * 协程任务示例：ESP8266 上电联网流程
+ *
+ * 传统写法中每一步 AT 指令都要阻塞等待应答（HAL_Delay/轮询），期间其他任务无法运行。
+ * 改写为协程任务后，每个等待点都返回调度器，按键、显示等任务照常运行。
+ *
+ * 串口接收中断把收到的每一行应答通过 TaskManager_SendTaskMessage() 投递到联网任务的消息队列。
+ */
+
+#define ESP_UART            huart2
+#define ESP_REPLY_TIMEOUT   2000    // 单条指令应答超时（ms）
+#define ESP_LINE_MAX        64      // 应答行最大长度
+
+/* 联网任务句柄 */
+TaskHandle_t* wifi_task_handle = NULL;
+
+/* 联网流程上下文（跨越让出点的数据不能放在局部变量中） */
+typedef struct {
+    const char* const* cmds;        // 指令表
+    uint8_t cmd_index;              // 当前指令序号
+    uint8_t retry;                  // 当前指令已重试次数
+    uint32_t sent_time;             // 指令发送时间
+    uint8_t reply_ok;               // 是否收到OK
+    char line[ESP_LINE_MAX];        // 最近一行应答
+} WifiBringup_t;
+
+static const char* const wifi_cmds[] = {
+    "AT\r\n",
+    "AT+CWMODE=1\r\n",
+    "AT+CWJAP=\"ssid\",\"password\"\r\n",
+    "AT+CIPMUX=0\r\n",
+    NULL
+};
+
+static WifiBringup_t wifi_ctx = { wifi_cmds, 0, 0, 0, 0, {0} };
+
+/* 发送一条AT指令 */
+static void ESP_SendCmd(const char* cmd)
+{
+    HAL_UART_Transmit(&ESP_UART, (uint8_t*)cmd, strlen(cmd), 100);
+}
+
+/* 读取一行应答，判断是否为OK/ERROR；返回1表示本条指令已有结论 */
+static uint8_t ESP_ReadReply(WifiBringup_t* ctx)
+{
+    uint16_t size = 0;
+
+    while (TaskManager_ReceiveTaskMessage(wifi_task_handle, ctx->line, sizeof(ctx->line) - 1, &size) == 0) {
+        ctx->line[size] = '\0';
+        if (strstr(ctx->line, "OK") != NULL) {
+            ctx->reply_ok = 1;
+            return 1;
+        }
+        if (strstr(ctx->line, "ERROR") != NULL || strstr(ctx->line, "FAIL") != NULL) {
+            ctx->reply_ok = 0;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief ESP8266联网协程任务
+ * @param param 联网流程上下文
+ */
+void WiFi_Bringup_Task(void* param)
+{
+    WifiBringup_t* ctx = (WifiBringup_t*)param;
+
+    TM_BEGIN();
+
+    // 模块上电后等待启动完成
+    TM_DELAY(1000);
+
+    for (ctx->cmd_index = 0; ctx->cmds[ctx->cmd_index] != NULL; ctx->cmd_index++) {
+        for (ctx->retry = 0; ctx->retry < 3; ctx->retry++) {
+            ESP_SendCmd(ctx->cmds[ctx->cmd_index]);
+            ctx->sent_time = HAL_GetTick();
+            ctx->reply_ok = 0;
+
+            // 等待应答或超时：等待期间任务不被分派，串口收到应答行时立即唤醒
+            while (!ESP_ReadReply(ctx) && HAL_GetTick() - ctx->sent_time < ESP_REPLY_TIMEOUT) {
+                TM_WAIT_MSG_TIMEOUT(ESP_REPLY_TIMEOUT - (HAL_GetTick() - ctx->sent_time));
+            }
+
+            if (ctx->reply_ok) {
+                break;
+            }
+            printf("WiFi: %s 第%u次失败\r\n", ctx->cmds[ctx->cmd_index], ctx->retry + 1);
+            TM_DELAY(500);
+        }
+
+        if (!ctx->reply_ok) {
+            printf("WiFi: 联网失败，10秒后重试\r\n");
+            TM_DELAY(10000);
+            TM_RESTART();
+        }
+    }
+
+    printf("WiFi: 联网完成\r\n");
+
+    // 联网完成后常驻：等待串口主动上报的数据
+    for (;;) {
+        TM_WAIT_MSG();
+        ESP_ReadReply(ctx);
+        printf("WiFi: 收到 %s", ctx->line);
+    }
+
+    TM_END();
+}
+
+/**
+ * @brief 串口接收到一行应答（在串口接收中断/回调中调用）
+ * @param line 应答行
+ * @param len 长度
+ */
+void WiFi_OnUartLine(const char* line, uint16_t len)
+{
+    TaskManager_SendTaskMessage(wifi_task_handle, line, len, 0);
+}
+
+/**
+ * @brief 协程示例初始化
+ */
+void TaskManager_CoroutineExample_Init(void)
+{
+    if (TaskManager_Init(8) != 0) {
+        printf("任务管理器初始化失败!\r\n");
+        return;
+    }
+
+    // 协程任务以周期0创建，由 TM_DELAY/TM_WAIT_* 自行控制节奏
+    wifi_task_handle = TaskManager_CreateTask("WIFI", WiFi_Bringup_Task, &wifi_ctx, 3, 0);
+    if (wifi_task_handle == NULL) {
+        printf("联网任务创建失败!\r\n");
+        return;
+    }
+    TaskManager_CreateTaskQueue(wifi_task_handle, 8, ESP_LINE_MAX);
+
+    TaskManager_StartScheduler();
+}
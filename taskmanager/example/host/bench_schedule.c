@@ -0,0 +1,93 @@
+/**
+ * @file bench_schedule.c
+ * @brief 任务调度器选取开销的主机端基准测试
+ * @details 测量 TaskManager_Schedule() 每次选取并分派一个任务的平均耗时随任务数量的变化。
+ *          任务函数为空函数，测得的时间基本就是调度器自身的开销。
+ *
+ * 编译运行（在 taskmanager 目录下）：
+ *   就绪队列模式：
+ *     gcc -O2 -Iexample/host -I. -I../msgqueue example/host/bench_schedule.c \
+ *         taskmanager.c ../msgqueue/msgqueue.c -o bench_schedule
+ *   线性扫描模式（对比）：
+ *     gcc -O2 -DTM_CONFIG_READY_QUEUE=0 -Iexample/host -I. -I../msgqueue \
+ *         example/host/bench_schedule.c taskmanager.c ../msgqueue/msgqueue.c -o bench_schedule_linear
+ */
+
+#include "taskmanager.h"
+#include <stdio.h>
+#include <time.h>
+
+/* 主机虚拟系统滴答 */
+volatile uint32_t host_tick = 0;
+
+uint32_t HAL_GetTick(void) {
+    return host_tick;
+}
+
+/* 每次测量的调度次数 */
+#define BENCH_ITERATIONS    200000
+
+/* 每多少次调度推进1ms虚拟时间 */
+#define BENCH_CALLS_PER_MS  20
+
+static void bench_task(void* param) {
+    (void)param;
+}
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief  创建task_count个任务并测量单次调度的平均耗时
+ * @param  task_count: 任务数量（不含空闲任务）
+ * @retval 每次调度的平均耗时（ns）
+ */
+static double bench_run(uint8_t task_count) {
+    char name[16];
+
+    host_tick = 0;
+    TaskManager_Init((uint8_t)(task_count + 1));
+
+    // 每4个任务中1个为常驻就绪任务，其余为不同周期的周期任务（大部分时间处于阻塞）
+    for (uint8_t i = 0; i < task_count; i++) {
+        snprintf(name, sizeof(name), "T%u", i);
+        uint32_t period = (i % 4 == 0) ? 0 : 10U * (i % 16 + 1);
+        TaskManager_CreateTask(name, bench_task, NULL, 1 + (i % 8), period);
+    }
+
+    g_task_manager.is_scheduling = 1;
+
+    // 预热
+    for (uint32_t i = 0; i < 1000; i++) {
+        TaskManager_Schedule();
+    }
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        if (i % BENCH_CALLS_PER_MS == 0) {
+            host_tick++;
+            TaskManager_Update();
+        }
+        TaskManager_Schedule();
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    g_task_manager.is_scheduling = 0;
+
+    return (double)elapsed / BENCH_ITERATIONS;
+}
+
+int main(void) {
+    static const uint8_t task_counts[] = {5, 10, 20, 30, 45, 60, 120, 250};
+
+    printf("# scheduler mode: %s\n", TM_CONFIG_READY_QUEUE ? "ready-queue" : "linear-scan");
+    printf("tasks,ns_per_pick\n");
+    for (size_t i = 0; i < sizeof(task_counts) / sizeof(task_counts[0]); i++) {
+        printf("%u,%.1f\n", task_counts[i], bench_run(task_counts[i]));
+    }
+
+    return 0;
+}
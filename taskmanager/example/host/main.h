@@ -0,0 +1,18 @@
+/**
+ * @file main.h
+ * @brief 主机端（Linux/PC）构建用的最小HAL替身
+ * @details 仅提供任务管理器和消息队列所需的HAL_GetTick()，
+ *          时钟由主机程序自行驱动（见 host_tick）。
+ */
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include <stdint.h>
+
+/* 主机虚拟系统滴答（ms），由主机程序负责递增 */
+extern volatile uint32_t host_tick;
+
+/* 获取系统滴答值 */
+uint32_t HAL_GetTick(void);
+
+#endif /* __MAIN_H */
@@ -0,0 +1,97 @@
+/**
+ * @file soak_threads.c
+ * @brief 主机多线程后端（TM_CONFIG_HOST_THREADS）浸泡测试
+ * @details 模拟200个设备任务挂在8条共享总线上：同一总线上的设备任务属于同一互斥组，
+ *          任务执行期间检查是否有同组任务并行（冲突计数应为0）。
+ *          对不同工作线程数各运行一段时间，输出每秒分派次数（CSV）。
+ *
+ * 编译运行（在 taskmanager 目录下）：
+ *   gcc -O2 -pthread -DTM_CONFIG_HOST_THREADS=1 -Iexample/host -I. -I../msgqueue \
+ *       example/host/soak_threads.c taskmanager.c ../msgqueue/msgqueue.c -o soak_threads
+ */
+
+#include "taskmanager.h"
+#include <stdio.h>
+#include <time.h>
+
+/* 主机系统滴答：真实单调时钟（ms） */
+volatile uint32_t host_tick = 0;
+
+uint32_t HAL_GetTick(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
+}
+
+#define SOAK_DEVICES        200     // 模拟设备数
+#define SOAK_BUSES          8       // 共享总线数（互斥组）
+#define SOAK_PERIOD_MS      5       // 设备轮询周期
+#define SOAK_WORK_US        20      // 每次轮询占用总线的时间
+#define SOAK_DURATION_MS    2000    // 每种线程数运行时间
+
+/* 每条总线上正在执行的任务数（大于1即为冲突） */
+static volatile int bus_users[SOAK_BUSES];
+static volatile int bus_conflicts = 0;
+static volatile unsigned long device_polls = 0;
+static uint32_t soak_end_time = 0;
+
+static void busy_wait_us(uint32_t us) {
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000000L + (now.tv_nsec - start.tv_nsec) / 1000L < (long)us);
+}
+
+/* 设备任务：占用所在总线一段时间 */
+static void device_task(void* param) {
+    int bus = (int)(uintptr_t)param;
+
+    if (__atomic_add_fetch(&bus_users[bus], 1, __ATOMIC_SEQ_CST) > 1) {
+        __atomic_add_fetch(&bus_conflicts, 1, __ATOMIC_SEQ_CST);
+    }
+    busy_wait_us(SOAK_WORK_US);
+    __atomic_sub_fetch(&bus_users[bus], 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&device_polls, 1, __ATOMIC_SEQ_CST);
+}
+
+/* 监控任务：到时停止调度 */
+static void supervisor_task(void* param) {
+    (void)param;
+    if (TM_TIME_AFTER_EQ(HAL_GetTick(), soak_end_time)) {
+        TaskManager_StopScheduler();
+    }
+}
+
+static void soak_run(uint8_t workers) {
+    char name[16];
+
+    TaskManager_Init(SOAK_DEVICES + 2);
+    TaskManager_SetWorkerCount(workers);
+    device_polls = 0;
+    bus_conflicts = 0;
+
+    for (int i = 0; i < SOAK_DEVICES; i++) {
+        snprintf(name, sizeof(name), "DEV%d", i);
+        TaskHandle_t* task = TaskManager_CreateTask(name, device_task, (void*)(uintptr_t)(i % SOAK_BUSES),
+                                                    2, SOAK_PERIOD_MS);
+        TaskManager_SetTaskGroup(task, (uint8_t)(i % SOAK_BUSES + 1));
+    }
+    TaskManager_CreateTask("SUPERVISOR", supervisor_task, NULL, 1, 10);
+
+    soak_end_time = HAL_GetTick() + SOAK_DURATION_MS;
+    TaskManager_StartScheduler();
+
+    printf("%u,%lu,%.0f,%d,%u\n", (unsigned)workers, device_polls,
+           device_polls * 1000.0 / SOAK_DURATION_MS, bus_conflicts, (unsigned)TaskManager_GetCpuLoad());
+}
+
+int main(void) {
+    static const uint8_t worker_counts[] = {1, 2, 4, 8};
+
+    printf("workers,polls,polls_per_s,bus_conflicts,cpu_load\n");
+    for (size_t i = 0; i < sizeof(worker_counts) / sizeof(worker_counts[0]); i++) {
+        soak_run(worker_counts[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file tickless_demo.c
+ * @brief 低功耗空闲（TM_CONFIG_TICKLESS）的主机端演示
+ * @details 睡眠函数直接把虚拟时钟推进到唤醒时间，统计一段虚拟时间内的睡眠占比。
+ *          任务执行本身不消耗虚拟时间，调度循环每执行一定次数推进1ms，模拟CPU忙碌。
+ *
+ * 编译运行（在 taskmanager 目录下）：
+ *   gcc -O2 -DTM_CONFIG_TICKLESS=1 -Iexample/host -I. -I../msgqueue \
+ *       example/host/tickless_demo.c taskmanager.c ../msgqueue/msgqueue.c -o tickless_demo
+ */
+
+#include "taskmanager.h"
+#include <stdio.h>
+
+/* 主机虚拟系统滴答 */
+volatile uint32_t host_tick = 0;
+
+uint32_t HAL_GetTick(void) {
+    return host_tick;
+}
+
+/* 演示的虚拟时间长度（ms） */
+#define DEMO_DURATION_MS    10000
+
+/* 每多少次调度推进1ms虚拟时间 */
+#define DEMO_CALLS_PER_MS   20
+
+/* 按键事件 */
+#define EVT_KEY             (1U << 0)
+
+static TaskHandle_t* key_task = NULL;
+static uint32_t key_events = 0;
+
+static void led_task(void* param) {
+    (void)param;
+}
+
+static void sensor_task(void* param) {
+    (void)param;
+}
+
+/* 事件驱动任务：只在按键中断置位事件时运行 */
+static void key_handler_task(void* param) {
+    (void)param;
+    if (TaskManager_WaitEvents(EVT_KEY, TM_EVENT_WAIT_ANY, TM_WAIT_FOREVER) == 0) {
+        return;
+    }
+    key_events++;
+}
+
+/* 虚拟时钟睡眠函数：在唤醒时间到来前模拟一次按键中断 */
+static uint32_t host_sleep(uint32_t sleep_ms) {
+    static uint32_t next_key_time = 3000;
+    uint32_t slept = sleep_ms;
+
+    if (host_tick + sleep_ms >= next_key_time) {
+        // 中断提前唤醒
+        slept = next_key_time - host_tick;
+        host_tick += slept;
+        TaskManager_SetEvents(key_task, EVT_KEY);
+        next_key_time += 3000;
+        return slept;
+    }
+
+    host_tick += slept;
+    return slept;
+}
+
+static void demo_run(TaskSleepHook_t hook) {
+    uint32_t sleep_ms = 0;
+    uint32_t sleep_count = 0;
+    uint32_t calls = 0;
+
+    host_tick = 0;
+    key_events = 0;
+    TaskManager_Init(8);
+    TaskManager_SetSleepHook(hook);
+
+    TaskManager_CreateTask("LED", led_task, NULL, 3, 500);
+    TaskManager_CreateTask("SENSOR", sensor_task, NULL, 2, 100);
+    key_task = TaskManager_CreateTask("KEY", key_handler_task, NULL, 1, 0);
+
+    g_task_manager.is_scheduling = 1;
+    while (host_tick < DEMO_DURATION_MS) {
+        uint32_t before = host_tick;
+        TaskManager_Schedule();
+        if (host_tick != before) {
+            TaskManager_Update();  // 醒来后的节拍中断
+        } else if (++calls % DEMO_CALLS_PER_MS == 0) {
+            host_tick++;
+            TaskManager_Update();
+        }
+    }
+    g_task_manager.is_scheduling = 0;
+
+    TaskManager_GetSleepStats(&sleep_ms, &sleep_count);
+    printf("%s,%lu,%lu,%lu,%.1f,%u,%lu\n",
+           hook != NULL ? "tickless" : "busy-idle",
+           (unsigned long)host_tick, (unsigned long)sleep_ms, (unsigned long)sleep_count,
+           100.0 * sleep_ms / host_tick, (unsigned)TaskManager_GetCpuLoad(),
+           (unsigned long)key_events);
+}
+
+int main(void) {
+    printf("mode,virtual_ms,asleep_ms,sleeps,asleep_pct,cpu_load,key_events\n");
+    demo_run(NULL);
+    demo_run(host_sleep);
+    TaskManager_DumpStats();
+    return 0;
+}
@@ -1,52 +1,802 @@
 #include "taskmanager.h"
 #include <stdlib.h>
+#include <stdio.h>
+#if TM_CONFIG_HOST_THREADS
+#include <pthread.h>
+#include <time.h>
+#endif
 
 /* 全局任务管理器实例 */
 TaskManager_t g_task_manager = {0};
 
+/* 主机多线程后端中每个工作线程各自记录当前任务 */
+#if TM_CONFIG_HOST_THREADS
+#define TM_THREAD_LOCAL         __thread
+#else
+#define TM_THREAD_LOCAL
+#endif
+
+/* 当前正在执行的任务 */
+static TM_THREAD_LOCAL TaskHandle_t* tm_current_task = NULL;
+
+/* 调度标志：主机多线程后端中由工作线程在锁外轮询、由其他线程停止调度，需原子读写 */
+#if TM_CONFIG_HOST_THREADS
+#define TM_IS_SCHEDULING()          __atomic_load_n(&g_task_manager.is_scheduling, __ATOMIC_ACQUIRE)
+#define TM_SET_SCHEDULING(value)    __atomic_store_n(&g_task_manager.is_scheduling, (uint8_t)(value), __ATOMIC_RELEASE)
+#else
+#define TM_IS_SCHEDULING()          (g_task_manager.is_scheduling)
+#define TM_SET_SCHEDULING(value)    (g_task_manager.is_scheduling = (uint8_t)(value))
+#endif
+
+#if TM_CONFIG_HOST_THREADS
+/* 调度器全局锁（递归：持锁调用的睡眠函数/回调中可以再次进入临界区） */
+static pthread_mutex_t tm_host_mutex;
+static pthread_once_t tm_host_once = PTHREAD_ONCE_INIT;
+
+/* 有任务就绪或互斥组释放时唤醒空闲的工作线程 */
+static pthread_cond_t tm_host_cond = PTHREAD_COND_INITIALIZER;
+
+static void tm_host_mutex_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&tm_host_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/**
+ * @brief  进入调度器临界区（主机多线程后端）
+ * @retval 临界区状态（未使用）
+ */
+uint32_t TM_Host_Lock(void) {
+    pthread_once(&tm_host_once, tm_host_mutex_init);
+    pthread_mutex_lock(&tm_host_mutex);
+    return 0;
+}
+
+/**
+ * @brief  退出调度器临界区（主机多线程后端）
+ * @param  state: TM_Host_Lock()的返回值
+ * @retval 无
+ */
+void TM_Host_Unlock(uint32_t state) {
+    (void)state;
+    pthread_mutex_unlock(&tm_host_mutex);
+}
+#endif /* TM_CONFIG_HOST_THREADS */
+
+#if TM_CONFIG_PROFILING
+#if defined(DWT) && defined(DWT_CTRL_CYCCNTENA_Msk)
+/* 默认周期计数器：DWT周期计数器（由DWT_Delay_Init()使能） */
+static uint32_t tm_dwt_cycles(void) {
+    return DWT->CYCCNT;
+}
+static TaskCycleCounter_t tm_cycle_counter = tm_dwt_cycles;
+#else
+static TaskCycleCounter_t tm_cycle_counter = NULL;
+#endif
+
+/* 读取周期计数器 */
+static inline uint32_t tm_read_cycles(void) {
+    return (tm_cycle_counter != NULL) ? tm_cycle_counter() : 0;
+}
+
+/* 记录一次任务执行耗时 */
+static void tm_record_exec(TaskHandle_t* task, uint32_t cycles) {
+    task->exec_last = cycles;
+    task->exec_total += cycles;
+    if (cycles > task->exec_max) {
+        task->exec_max = cycles;
+    }
+    if (task->exec_min == 0 || cycles < task->exec_min) {
+        task->exec_min = cycles;
+    }
+}
+#endif /* TM_CONFIG_PROFILING */
+
+#if TM_CONFIG_TICKLESS
+#if defined(SysTick) && defined(SysTick_CTRL_COUNTFLAG_Msk)
+/**
+ * 默认睡眠函数：把SysTick重装值放大到整个睡眠时长后执行WFI（节拍中断暂停），
+ * 醒来后根据计数值计算实际经过的毫秒数，用HAL_IncTick()补偿HAL滴答
+ */
+static uint32_t tm_systick_sleep(uint32_t sleep_ms) {
+    uint32_t ticks_per_ms = SysTick->LOAD + 1U;  // HAL将SysTick配置为1ms中断
+    uint32_t max_ms = (SysTick_LOAD_RELOAD_Msk + 1U) / ticks_per_ms;
+    if (sleep_ms > max_ms) {
+        sleep_ms = max_ms;
+    }
+
+    // 停止计数，当前1ms周期的剩余部分计入睡眠时长
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    uint32_t remaining = SysTick->VAL;
+    uint32_t reload = remaining + (sleep_ms - 1U) * ticks_per_ms;
+    SysTick->LOAD = reload;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();
+    __ISB();
+
+    // 读取CTRL会清除COUNTFLAG，先保存
+    uint32_t ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+
+    uint32_t slept;
+    uint32_t next_load;
+    if (ctrl & SysTick_CTRL_COUNTFLAG_Msk) {
+        // 睡满全程：挂起的SysTick中断会再计1ms
+        slept = sleep_ms;
+        next_load = ticks_per_ms;
+        for (uint32_t i = 1; i < slept; i++) {
+            HAL_IncTick();
+        }
+    } else {
+        // 被其他中断提前唤醒：补偿已经过的整毫秒数，剩余部分作为下一个节拍周期
+        uint32_t elapsed = reload - SysTick->VAL;
+        if (elapsed < remaining) {
+            slept = 0;
+            next_load = remaining - elapsed;
+        } else {
+            uint32_t after = elapsed - remaining;
+            slept = 1U + after / ticks_per_ms;
+            next_load = ticks_per_ms - after % ticks_per_ms;
+        }
+        for (uint32_t i = 0; i < slept; i++) {
+            HAL_IncTick();
+        }
+    }
+
+    // 先按剩余部分计数，重装后恢复1ms节拍
+    SysTick->LOAD = next_load - 1U;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = ticks_per_ms - 1U;
+
+    return slept;
+}
+static TaskSleepHook_t tm_sleep_hook = tm_systick_sleep;
+#else
+static TaskSleepHook_t tm_sleep_hook = NULL;
+#endif
+
+static void tm_tickless_idle(void);
+#endif /* TM_CONFIG_TICKLESS */
+
+/* 空闲计数参考值（0表示自动学习） */
+static uint32_t tm_idle_reference = 0;
+
+/* 每个统计窗口结束时根据空闲计数估计CPU负载 */
+static void tm_update_load(uint32_t current_time) {
+    if (!TM_TIME_AFTER_EQ(current_time, g_task_manager.load_window_start + TM_CONFIG_LOAD_WINDOW_MS)) {
+        return;
+    }
+
+    // 有睡眠时按窗口内醒着的时间比例估计负载
+    uint32_t sleep_delta = g_task_manager.sleep_total_ms - g_task_manager.load_sleep_snapshot;
+    if (sleep_delta > 0) {
+        uint32_t window = current_time - g_task_manager.load_window_start;
+        g_task_manager.cpu_load = (sleep_delta >= window) ? 0 :
+                                  (uint8_t)(100 - (uint64_t)sleep_delta * 100 / window);
+        g_task_manager.load_window_start = current_time;
+        g_task_manager.load_idle_snapshot = g_task_manager.idle_count;
+        g_task_manager.load_sleep_snapshot = g_task_manager.sleep_total_ms;
+        return;
+    }
+
+    uint32_t idle_delta = g_task_manager.idle_count - g_task_manager.load_idle_snapshot;
+    uint32_t reference = tm_idle_reference;
+    if (reference == 0) {
+        if (idle_delta > g_task_manager.idle_peak) {
+            g_task_manager.idle_peak = idle_delta;
+        }
+        reference = g_task_manager.idle_peak;
+    }
+
+    if (reference == 0 || idle_delta >= reference) {
+        g_task_manager.cpu_load = (reference == 0) ? 100 : 0;
+    } else {
+        g_task_manager.cpu_load = (uint8_t)(100 - (uint64_t)idle_delta * 100 / reference);
+    }
+
+    g_task_manager.load_window_start = current_time;
+    g_task_manager.load_idle_snapshot = g_task_manager.idle_count;
+}
+
 /* 内部使用的空闲任务 */
 static void idle_task(void* param) {
     g_task_manager.idle_count++;
+#if TM_CONFIG_TICKLESS
+    tm_tickless_idle();
+#endif
 }
 
-/**
- * @brief  初始化任务管理器
- * @param  max_tasks: 最大任务数量
- * @retval 0:成功 非0:失败
- */
-uint8_t TaskManager_Init(uint8_t max_tasks) {
-    // 参数检查
-    if (max_tasks == 0) {
-        return 1;
+/* 记录周期任务本次分派相对应运行时间的延迟 */
+static void tm_record_lateness(TaskHandle_t* task, uint32_t dispatch_time, uint32_t release_time) {
+    uint32_t lateness = TM_TIME_AFTER_EQ(dispatch_time, release_time) ? (dispatch_time - release_time) : 0;
+
+    task->last_lateness = lateness;
+    if (lateness > task->max_lateness) {
+        task->max_lateness = lateness;
     }
+    // 延迟达到一个周期，说明本次已错过截止时间（即下一次的应运行时间）
+    if (lateness >= task->period) {
+        task->missed_count++;
+    }
+}
 
-    // 如果已经初始化过，先清理现有资源
-    if (g_task_manager.is_initialized) {
-        if (g_task_manager.tasks != NULL) {
-            free(g_task_manager.tasks);
-            g_task_manager.tasks = NULL;
+/* 计算周期任务的下次运行时间 */
+static uint32_t tm_next_release(TaskHandle_t* task, uint32_t dispatch_time, uint32_t release_time) {
+    if (task->period_mode != TASK_PERIOD_FIXED_RATE) {
+        // 固定间隔：以本次分派时间为起点
+        return dispatch_time + task->period;
+    }
+
+    // 固定速率：以上次应运行时间为锚点，分派延迟不会累积
+    uint32_t next = release_time + task->period;
+    uint32_t now = HAL_GetTick();
+    if (task->overrun_policy == TASK_OVERRUN_SKIP && TM_TIME_AFTER_EQ(now, next)) {
+        // 已错过多个周期：只保留最近一个已到期的节拍，其余跳过
+        uint32_t elapsed_periods = (now - release_time) / task->period;
+        task->skipped_count += elapsed_periods - 1;
+        next = release_time + elapsed_periods * task->period;
+    }
+    return next;
+}
+
+#if TM_CONFIG_READY_QUEUE
+
+/* 任务所在链表标识 */
+#define TM_LIST_NONE        0   // 不在任何链表中（运行/挂起/删除）
+#define TM_LIST_READY       1   // 在就绪桶中
+#define TM_LIST_DELAYED     2   // 在唤醒堆中
+
+/* 优先级映射到就绪桶 */
+static inline uint32_t tm_prio_bucket(uint32_t priority) {
+    return (priority < (TM_CONFIG_PRIO_LEVELS - 1)) ? priority : (TM_CONFIG_PRIO_LEVELS - 1);
+}
+
+/* 查找位图中最低的置位位（即最高优先级的非空桶） */
+static inline uint32_t tm_find_first_set(uint32_t bitmap) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(bitmap);
+#elif defined(__CC_ARM) || defined(__ICCARM__)
+    return __CLZ(__RBIT(bitmap));
+#else
+    uint32_t bit = 0;
+    while ((bitmap & 1U) == 0U) {
+        bitmap >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/* 在链表节点pos之前插入任务（pos为NULL时追加到尾部） */
+static void tm_list_insert_before(TaskList_t* list, TaskHandle_t* pos, TaskHandle_t* task) {
+    task->list_next = pos;
+    if (pos == NULL) {
+        task->list_prev = list->tail;
+        if (list->tail != NULL) {
+            list->tail->list_next = task;
+        } else {
+            list->head = task;
         }
+        list->tail = task;
+    } else {
+        task->list_prev = pos->list_prev;
+        if (pos->list_prev != NULL) {
+            pos->list_prev->list_next = task;
+        } else {
+            list->head = task;
+        }
+        pos->list_prev = task;
     }
+}
 
-    // 分配任务数组内存
-    g_task_manager.tasks = (TaskHandle_t*)malloc(max_tasks * sizeof(TaskHandle_t));
-    if (g_task_manager.tasks == NULL) {
-        return 2;  // 内存分配失败
+/* 从链表中摘除任务 */
+static void tm_list_unlink(TaskList_t* list, TaskHandle_t* task) {
+    if (task->list_prev != NULL) {
+        task->list_prev->list_next = task->list_next;
+    } else {
+        list->head = task->list_next;
+    }
+    if (task->list_next != NULL) {
+        task->list_next->list_prev = task->list_prev;
+    } else {
+        list->tail = task->list_prev;
+    }
+    task->list_next = NULL;
+    task->list_prev = NULL;
+}
+
+/* 将任务挂入对应优先级就绪桶的尾部 */
+static void tm_ready_add(TaskHandle_t* task) {
+    uint32_t bucket = tm_prio_bucket(task->priority);
+    TaskList_t* list = &g_task_manager.ready_lists[bucket];
+    TaskHandle_t* pos = NULL;
+
+    // 最后一个桶混有多个优先级（包括空闲任务），按优先级数值有序插入到同优先级任务之后，
+    // 与线性扫描模式一致：数值较小的任务总是先于空闲任务被选中
+    if (bucket == TM_CONFIG_PRIO_LEVELS - 1) {
+        for (pos = list->head; pos != NULL && pos->priority <= task->priority; pos = pos->list_next) {
+        }
+    }
+    tm_list_insert_before(list, pos, task);
+    g_task_manager.ready_bitmap |= (1UL << bucket);
+    task->list_id = TM_LIST_READY;
+    task->status = TASK_READY;
+#if TM_CONFIG_HOST_THREADS
+    pthread_cond_broadcast(&tm_host_cond);
+#endif
+}
+
+/* 唤醒堆：交换两个节点并维护下标 */
+static inline void tm_heap_swap(uint8_t i, uint8_t j) {
+    TaskHandle_t** heap = g_task_manager.delay_heap;
+    TaskHandle_t* tmp = heap[i];
+    heap[i] = heap[j];
+    heap[j] = tmp;
+    heap[i]->heap_index = i;
+    heap[j]->heap_index = j;
+}
+
+/* 唤醒堆：上浮 */
+static void tm_heap_sift_up(uint8_t index) {
+    TaskHandle_t** heap = g_task_manager.delay_heap;
+    while (index > 0) {
+        uint8_t parent = (uint8_t)((index - 1) / 2);
+        if (!TM_TIME_BEFORE(heap[index]->next_run_time, heap[parent]->next_run_time)) {
+            break;
+        }
+        tm_heap_swap(index, parent);
+        index = parent;
     }
+}
+
+/* 唤醒堆：下沉 */
+static void tm_heap_sift_down(uint8_t index) {
+    TaskHandle_t** heap = g_task_manager.delay_heap;
+    uint8_t count = g_task_manager.delay_count;
+    for (;;) {
+        uint16_t left = (uint16_t)index * 2 + 1;
+        uint16_t right = left + 1;
+        uint8_t smallest = index;
+        if (left < count &&
+            TM_TIME_BEFORE(heap[left]->next_run_time, heap[smallest]->next_run_time)) {
+            smallest = (uint8_t)left;
+        }
+        if (right < count &&
+            TM_TIME_BEFORE(heap[right]->next_run_time, heap[smallest]->next_run_time)) {
+            smallest = (uint8_t)right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        tm_heap_swap(index, smallest);
+        index = smallest;
+    }
+}
+
+/* 将任务按next_run_time加入唤醒堆，O(log n) */
+static void tm_delayed_add(TaskHandle_t* task) {
+    uint8_t index = g_task_manager.delay_count++;
+    g_task_manager.delay_heap[index] = task;
+    task->heap_index = index;
+    tm_heap_sift_up(index);
+    task->list_id = TM_LIST_DELAYED;
+    task->status = TASK_BLOCKED;
+    if (g_task_manager.delay_count > g_task_manager.delay_peak) {
+        g_task_manager.delay_peak = g_task_manager.delay_count;
+    }
+}
+
+/* 将任务从唤醒堆中移除，O(log n) */
+static void tm_delayed_remove(TaskHandle_t* task) {
+    uint8_t index = task->heap_index;
+    uint8_t last = --g_task_manager.delay_count;
+    if (index != last) {
+        g_task_manager.delay_heap[index] = g_task_manager.delay_heap[last];
+        g_task_manager.delay_heap[index]->heap_index = index;
+        tm_heap_sift_down(index);
+        tm_heap_sift_up(index);
+    }
+}
+
+/* 将任务从其所在链表中移除 */
+static void tm_list_remove(TaskHandle_t* task) {
+    if (task->list_id == TM_LIST_READY) {
+        uint32_t bucket = tm_prio_bucket(task->priority);
+        tm_list_unlink(&g_task_manager.ready_lists[bucket], task);
+        if (g_task_manager.ready_lists[bucket].head == NULL) {
+            g_task_manager.ready_bitmap &= ~(1UL << bucket);
+        }
+    } else if (task->list_id == TM_LIST_DELAYED) {
+        tm_delayed_remove(task);
+    }
+    task->list_id = TM_LIST_NONE;
+}
+
+/* 唤醒所有已到期的阻塞任务（堆顶未到期时O(1)返回，只访问到期的任务） */
+static void tm_wake_expired(uint32_t current_time) {
+    while (g_task_manager.delay_count > 0) {
+        TaskHandle_t* task = g_task_manager.delay_heap[0];
+        if (!TM_TIME_AFTER_EQ(current_time, task->next_run_time)) {
+            break;
+        }
+        tm_list_remove(task);
+        tm_ready_add(task);
+    }
+}
+
+/* 取出最高优先级就绪桶的队首任务 */
+static TaskHandle_t* tm_pick_next(void) {
+    if (g_task_manager.ready_bitmap == 0) {
+        return NULL;
+    }
+    uint32_t bucket = tm_find_first_set(g_task_manager.ready_bitmap);
+    TaskHandle_t* task = g_task_manager.ready_lists[bucket].head;
+    tm_list_remove(task);
+    return task;
+}
+
+#endif /* TM_CONFIG_READY_QUEUE */
+
+#if TM_CONFIG_TICKLESS
+/* 计算距最早唤醒时间的毫秒数；有就绪任务时返回0（不能睡眠） */
+static uint32_t tm_next_wake_delay(uint32_t current_time) {
+    uint32_t delay = TM_CONFIG_TICKLESS_MAX_MS;
+
+#if TM_CONFIG_READY_QUEUE
+    // 空闲任务运行时已从就绪桶取出，位图非空说明还有其他就绪任务
+    if (g_task_manager.ready_bitmap != 0) {
+        return 0;
+    }
+    if (g_task_manager.delay_count > 0) {
+        uint32_t wake_time = g_task_manager.delay_heap[0]->next_run_time;
+        if (TM_TIME_AFTER_EQ(current_time, wake_time)) {
+            return 0;
+        }
+        if (wake_time - current_time < delay) {
+            delay = wake_time - current_time;
+        }
+    }
+#else
+    for (uint8_t i = 0; i < g_task_manager.slot_top; i++) {
+        TaskHandle_t* task = &g_task_manager.tasks[i];
+        if (task->status == TASK_READY) {
+            return 0;
+        }
+        if (task->status == TASK_BLOCKED && !task->wait_forever) {
+            if (TM_TIME_AFTER_EQ(current_time, task->next_run_time)) {
+                return 0;
+            }
+            if (task->next_run_time - current_time < delay) {
+                delay = task->next_run_time - current_time;
+            }
+        }
+    }
+#endif
+
+    return delay;
+}
+
+/* 空闲任务中进入低功耗睡眠，直到最早的任务唤醒时间或被中断唤醒 */
+static void tm_tickless_idle(void) {
+    if (tm_sleep_hook == NULL) {
+        return;
+    }
+
+    // 判断与睡眠在同一临界区内完成：中断在此期间就绪任务时WFI会立即返回
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    uint32_t delay = tm_next_wake_delay(HAL_GetTick());
+    if (delay >= TM_CONFIG_TICKLESS_MIN_MS) {
+        g_task_manager.sleep_total_ms += tm_sleep_hook(delay);
+        g_task_manager.sleep_count++;
+    }
+    TM_CRITICAL_EXIT(irq_state);
+}
+#endif /* TM_CONFIG_TICKLESS */
+
+/* 任务等待对象 */
+#define TM_WAITING_NONE         0
+#define TM_WAITING_MSG          1
+#define TM_WAITING_EVENTS       2
+
+/* 空槽位/空哈希链标记 */
+#define TM_SLOT_NONE            0xFF
+
+/* 任务ID中槽位下标占用的位数 */
+#define TM_ID_SLOT_BITS         8U
+#define TM_ID_GEN_MASK          0x00FFFFFFU
+
+/* 任务名称哈希（FNV-1a） */
+static uint8_t tm_name_hash(const char* name) {
+    uint32_t hash = 2166136261U;
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619U;
+    }
+    return (uint8_t)(hash & (TM_CONFIG_NAME_HASH_SIZE - 1));
+}
+
+/* 将任务挂到名称哈希链尾部（同名任务按创建顺序查找） */
+static void tm_name_index_add(TaskHandle_t* task) {
+    uint8_t* link = &g_task_manager.name_hash[tm_name_hash(task->name)];
+    while (*link != TM_SLOT_NONE) {
+        link = &g_task_manager.tasks[*link].hash_next;
+    }
+    task->hash_next = TM_SLOT_NONE;
+    *link = task->slot;
+}
+
+/* 将任务从名称哈希链摘除 */
+static void tm_name_index_remove(TaskHandle_t* task) {
+    uint8_t* link = &g_task_manager.name_hash[tm_name_hash(task->name)];
+    while (*link != TM_SLOT_NONE) {
+        if (*link == task->slot) {
+            *link = task->hash_next;
+            return;
+        }
+        link = &g_task_manager.tasks[*link].hash_next;
+    }
+}
+
+/* 阻塞任务等待消息/事件（调用者已进入临界区） */
+static void tm_block_wait(TaskHandle_t* task, uint8_t wait_type, uint32_t timeout) {
+    task->wait_type = wait_type;
+    task->wait_forever = (timeout == TM_WAIT_FOREVER);
+    task->next_run_time = HAL_GetTick() + timeout;
+#if TM_CONFIG_READY_QUEUE
+    // 有超时的等待进入唤醒堆，超时到期按普通延时唤醒；永久等待只由发送方唤醒
+    tm_list_remove(task);
+    if (task->wait_forever) {
+        task->status = TASK_BLOCKED;
+    } else {
+        tm_delayed_add(task);
+    }
+#else
+    task->status = TASK_BLOCKED;
+#endif
+}
+
+/* 唤醒正在等待消息/事件的任务（调用者已进入临界区） */
+static void tm_wake_waiter(TaskHandle_t* task) {
+    task->wait_type = TM_WAITING_NONE;
+    task->wait_forever = 0;
+    task->next_run_time = HAL_GetTick();
+#if TM_CONFIG_READY_QUEUE
+    tm_list_remove(task);
+    tm_ready_add(task);
+#else
+    task->status = TASK_READY;
+#endif
+}
+
+/* 判断事件标志是否满足等待条件，返回匹配的标志（不满足返回0） */
+static uint32_t tm_events_match(uint32_t flags, uint32_t mask, uint8_t options) {
+    if (options & TM_EVENT_WAIT_ALL) {
+        return ((flags & mask) == mask) ? mask : 0;
+    }
+    return flags & mask;
+}
+
+/* 检查句柄是否指向任务数组中一个未删除的任务 */
+static uint8_t tm_task_valid(const TaskHandle_t* task) {
+    if (task < g_task_manager.tasks || task >= g_task_manager.tasks + g_task_manager.slot_top) {
+        return 0;
+    }
+    return (task == &g_task_manager.tasks[task->slot]) && (task->status != TASK_DELETED);
+}
+
+/* 初始化任务管理器公共部分（任务数组和唤醒堆已准备好） */
+static void tm_init_common(TaskHandle_t* tasks, TaskHandle_t** delay_heap, uint8_t max_tasks) {
+    g_task_manager.tasks = tasks;
+#if TM_CONFIG_READY_QUEUE
+    g_task_manager.delay_heap = delay_heap;
+#else
+    (void)delay_heap;
+#endif
 
     // 初始化任务管理器属性
     g_task_manager.max_tasks = max_tasks;
     g_task_manager.task_count = 0;
+    g_task_manager.slot_top = 0;
+    g_task_manager.free_head = TM_SLOT_NONE;
+    memset(g_task_manager.name_hash, TM_SLOT_NONE, sizeof(g_task_manager.name_hash));
     g_task_manager.current_task_index = 0;
     g_task_manager.task_switch_count = 0;
     g_task_manager.idle_count = 0;
     g_task_manager.is_scheduling = 0;
+    g_task_manager.cpu_load = 0;
+    g_task_manager.load_window_start = HAL_GetTick();
+    g_task_manager.load_idle_snapshot = 0;
+    g_task_manager.idle_peak = 0;
+    g_task_manager.sleep_total_ms = 0;
+    g_task_manager.sleep_count = 0;
+    g_task_manager.load_sleep_snapshot = 0;
+    g_task_manager.task_peak = 0;
+    g_task_manager.queue_arena_used = 0;
+    g_task_manager.queue_arena_peak = 0;
+#if TM_CONFIG_READY_QUEUE
+    memset(g_task_manager.ready_lists, 0, sizeof(g_task_manager.ready_lists));
+    g_task_manager.delay_count = 0;
+    g_task_manager.delay_peak = 0;
+    g_task_manager.ready_bitmap = 0;
+#endif
+#if TM_CONFIG_HOST_THREADS
+    g_task_manager.group_busy = 0;
+    g_task_manager.worker_count = TM_CONFIG_HOST_WORKERS;
+#endif
     g_task_manager.is_initialized = 1;
 
     // 创建空闲任务（最低优先级）
     TaskManager_CreateTask("IDLE", idle_task, NULL, 0xFFFFFFFF, 0);
+}
+
+#if !TM_CONFIG_STATIC_ONLY
+/* 释放堆分配的任务数组和唤醒堆（静态任务池不释放） */
+static void tm_release_heap(void) {
+    if (!g_task_manager.is_initialized || g_task_manager.is_static) {
+        return;
+    }
+    if (g_task_manager.tasks != NULL) {
+        free(g_task_manager.tasks);
+        g_task_manager.tasks = NULL;
+    }
+#if TM_CONFIG_READY_QUEUE
+    if (g_task_manager.delay_heap != NULL) {
+        free(g_task_manager.delay_heap);
+        g_task_manager.delay_heap = NULL;
+    }
+#endif
+}
 
+/**
+ * @brief  初始化任务管理器
+ * @param  max_tasks: 最大任务数量
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_Init(uint8_t max_tasks) {
+    // 参数检查
+    if (max_tasks == 0) {
+        return 1;
+    }
+
+    // 如果已经初始化过，先清理现有资源
+    tm_release_heap();
+
+    // 分配任务数组内存
+    TaskHandle_t* tasks = (TaskHandle_t*)malloc(max_tasks * sizeof(TaskHandle_t));
+    if (tasks == NULL) {
+        return 2;  // 内存分配失败
+    }
+
+    TaskHandle_t** delay_heap = NULL;
+#if TM_CONFIG_READY_QUEUE
+    // 分配唤醒堆（每个任务最多在堆中出现一次）
+    delay_heap = (TaskHandle_t**)malloc(max_tasks * sizeof(TaskHandle_t*));
+    if (delay_heap == NULL) {
+        free(tasks);
+        return 2;  // 内存分配失败
+    }
+#endif
+
+    g_task_manager.is_static = 0;
+    g_task_manager.queue_arena = NULL;
+    g_task_manager.queue_arena_size = 0;
+    tm_init_common(tasks, delay_heap, max_tasks);
+
+    return 0;
+}
+#endif /* !TM_CONFIG_STATIC_ONLY */
+
+/**
+ * @brief  使用静态任务池初始化任务管理器（不使用堆内存）
+ * @param  pool: 由 TASKMANAGER_DEFINE_POOL() 定义的任务池
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_InitStatic(TaskManager_Pool_t* pool) {
+    // 参数检查
+    if (pool == NULL || pool->tasks == NULL || pool->max_tasks == 0) {
+        return 1;
+    }
+#if TM_CONFIG_READY_QUEUE
+    if (pool->delay_heap == NULL) {
+        return 1;
+    }
+#endif
+
+#if !TM_CONFIG_STATIC_ONLY
+    // 如果之前用堆内存初始化过，先释放
+    tm_release_heap();
+#endif
+
+    g_task_manager.is_static = 1;
+    g_task_manager.queue_arena = pool->queue_arena;
+    g_task_manager.queue_arena_size = pool->queue_arena_size;
+    tm_init_common(pool->tasks, pool->delay_heap, pool->max_tasks);
+
+    return 0;
+}
+
+/* 按配置设置任务消息队列的出队顺序 */
+static void tm_queue_setup(MSGQUEUE_HandleTypeDef* queue) {
+#if TM_CONFIG_QUEUE_PRIORITY
+    MSGQUEUE_EnablePriority(queue);
+#else
+    (void)queue;
+#endif
+}
+
+/* 为任务分配并初始化消息队列 */
+static uint8_t tm_queue_alloc(TaskHandle_t* task, uint16_t queue_size, uint16_t msg_size) {
+    if (g_task_manager.is_static) {
+        // 从静态任务池的队列内存区顺序分配：队列句柄 + 消息存储区
+        uint32_t block_size = TM_POOL_QUEUE_BYTES(queue_size, msg_size);
+        if (queue_size == 0 || msg_size == 0 ||
+            g_task_manager.queue_arena_used + block_size > g_task_manager.queue_arena_size) {
+            return 2;  // 队列内存区不足
+        }
+        uint8_t* block = g_task_manager.queue_arena + g_task_manager.queue_arena_used;
+        MSGQUEUE_HandleTypeDef* queue = (MSGQUEUE_HandleTypeDef*)block;
+        uint8_t* storage = block + TM_POOL_ALIGN(sizeof(MSGQUEUE_HandleTypeDef));
+        if (MSGQUEUE_InitStatic(queue, queue_size, msg_size, storage,
+                                block_size - TM_POOL_ALIGN(sizeof(MSGQUEUE_HandleTypeDef))) != MSGQUEUE_OK) {
+            return 3;  // 队列初始化失败
+        }
+        g_task_manager.queue_arena_used += block_size;
+        if (g_task_manager.queue_arena_used > g_task_manager.queue_arena_peak) {
+            g_task_manager.queue_arena_peak = g_task_manager.queue_arena_used;
+        }
+        task->queue = queue;
+        tm_queue_setup(queue);
+        return 0;
+    }
+
+#if TM_CONFIG_STATIC_ONLY
+    return 2;
+#else
+    // 分配队列内存
+    task->queue = (MSGQUEUE_HandleTypeDef*)malloc(sizeof(MSGQUEUE_HandleTypeDef));
+    if (task->queue == NULL) {
+        return 2;  // 内存分配失败
+    }
+
+    // 初始化队列
+    MSGQUEUE_Status status = MSGQUEUE_Init(task->queue, queue_size, msg_size);
+    if (status != MSGQUEUE_OK) {
+        free(task->queue);
+        task->queue = NULL;
+        return 3;  // 队列初始化失败
+    }
+    tm_queue_setup(task->queue);
     return 0;
+#endif
+}
+
+/* 销毁并释放任务的消息队列 */
+static void tm_queue_release(TaskHandle_t* task) {
+    if (task->queue == NULL) {
+        return;
+    }
+
+    if (g_task_manager.is_static) {
+        // 静态任务池顺序分配，只有最后分配的队列内存可以回收
+        uint8_t* block = (uint8_t*)task->queue;
+        uint32_t block_size = TM_POOL_QUEUE_BYTES(task->queue->capacity, task->queue->max_msg_size);
+        MSGQUEUE_Deinit(task->queue);
+        if (block + block_size == g_task_manager.queue_arena + g_task_manager.queue_arena_used) {
+            g_task_manager.queue_arena_used -= block_size;
+        }
+    } else {
+        MSGQUEUE_Deinit(task->queue);
+#if !TM_CONFIG_STATIC_ONLY
+        free(task->queue);
+#endif
+    }
+    task->queue = NULL;
 }
 
 /**
@@ -69,9 +819,17 @@ TaskHandle_t* TaskManager_CreateTask(const char* name, TaskFunction_t function,
         return NULL;
     }
 
-    // 获取新任务的索引
-    uint8_t task_index = g_task_manager.task_count;
-    TaskHandle_t* task = &g_task_manager.tasks[task_index];
+    // 优先复用空闲槽位，否则取用新槽位
+    TaskHandle_t* task;
+    if (g_task_manager.free_head != TM_SLOT_NONE) {
+        task = &g_task_manager.tasks[g_task_manager.free_head];
+        g_task_manager.free_head = task->hash_next;
+    } else {
+        task = &g_task_manager.tasks[g_task_manager.slot_top];
+        task->slot = g_task_manager.slot_top;
+        task->generation = 1;
+        g_task_manager.slot_top++;
+    }
 
     // 初始化任务控制块
     strncpy(task->name, name, sizeof(task->name) - 1);
@@ -82,15 +840,49 @@ TaskHandle_t* TaskManager_CreateTask(const char* name, TaskFunction_t function,
     task->period = period;
     task->next_run_time = HAL_GetTick();  // 立即可运行
     task->run_count = 0;
+    task->period_mode = TASK_PERIOD_FIXED_DELAY;
+    task->overrun_policy = TASK_OVERRUN_CATCH_UP;
+    task->last_lateness = 0;
+    task->max_lateness = 0;
+    task->missed_count = 0;
+    task->skipped_count = 0;
+#if TM_CONFIG_PROFILING
+    task->exec_last = 0;
+    task->exec_min = 0;
+    task->exec_max = 0;
+    task->exec_total = 0;
+#endif
     task->timeout = 0;
     task->status = TASK_READY;
     task->queue = NULL;
     task->stack = NULL;
     task->stack_size = 0;
     task->user_data = NULL;
+    task->co_line = 0;
+    task->list_next = NULL;
+    task->list_prev = NULL;
+    task->list_id = 0;
+    task->heap_index = 0;
+    task->event_flags = 0;
+    task->wait_mask = 0;
+    task->wait_type = TM_WAITING_NONE;
+    task->wait_options = 0;
+    task->wait_forever = 0;
+    task->excl_group = 0;
+    tm_name_index_add(task);
 
     // 更新任务计数
     g_task_manager.task_count++;
+    if (g_task_manager.task_count > g_task_manager.task_peak) {
+        g_task_manager.task_peak = g_task_manager.task_count;
+    }
+
+#if TM_CONFIG_READY_QUEUE
+    // 挂入就绪链表
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    tm_ready_add(task);
+    TM_CRITICAL_EXIT(irq_state);
+#endif
 
     return task;
 }
@@ -106,52 +898,54 @@ uint8_t TaskManager_DeleteTask(TaskHandle_t* task) {
         return 1;
     }
 
-    // 查找任务在数组中的索引
-    int task_index = -1;
-    for (uint8_t i = 0; i < g_task_manager.task_count; i++) {
-        if (&g_task_manager.tasks[i] == task) {
-            task_index = i;
-            break;
-        }
-    }
-
-    // 任务未找到
-    if (task_index == -1) {
+    // 句柄必须指向未删除的任务
+    if (!tm_task_valid(task)) {
         return 2;
     }
 
     // 释放任务消息队列（如果有）
-    if (task->queue != NULL) {
-        MSGQUEUE_Deinit(task->queue);
-        free(task->queue);
-        task->queue = NULL;
-    }
+    tm_queue_release(task);
 
-    // 将删除的任务标记为已删除状态
-    task->status = TASK_DELETED;
+#if TM_CONFIG_READY_QUEUE
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    tm_list_remove(task);
+#endif
 
-    // 如果是最后一个任务，直接减少计数
-    if (task_index == g_task_manager.task_count - 1) {
-        g_task_manager.task_count--;
-        return 0;
+    // 将删除的任务标记为已删除状态，槽位代数递增使旧任务ID失效
+    task->status = TASK_DELETED;
+    task->generation = (task->generation + 1) & TM_ID_GEN_MASK;
+    if (task->generation == 0) {
+        task->generation = 1;
     }
 
-    // 否则移动其他任务填补空缺（保持数组紧凑）
-    for (uint8_t i = task_index; i < g_task_manager.task_count - 1; i++) {
-        g_task_manager.tasks[i] = g_task_manager.tasks[i + 1];
-    }
+#if TM_CONFIG_READY_QUEUE
+    TM_CRITICAL_EXIT(irq_state);
+#endif
 
-    // 更新任务计数
+    // 槽位放回空闲链表，其他任务的句柄保持不变
+    tm_name_index_remove(task);
+    task->hash_next = g_task_manager.free_head;
+    g_task_manager.free_head = task->slot;
     g_task_manager.task_count--;
 
-    // 如果当前正在执行的任务索引大于删除的索引，需要调整
-    if (g_task_manager.current_task_index > task_index) {
-        g_task_manager.current_task_index--;
-    }
-
     return 0;
 }
 
+/**
+ * @brief  协程宏的使用错误：输出错误，复位续点并挂起任务
+ * @param  task: 出错的任务
+ * @param  what: 错误说明
+ * @retval 无
+ */
+void TaskManager_CoroutineError(TaskHandle_t* task, const char* what) {
+    if (task == NULL) {
+        return;
+    }
+    TM_PRINTF("[%s] %s, task suspended\r\n", task->name, what);
+    task->co_line = 0;
+    TaskManager_SuspendTask(task);
+}
+
 /**
  * @brief  挂起任务
  * @param  task: 任务句柄
@@ -165,7 +959,14 @@ uint8_t TaskManager_SuspendTask(TaskHandle_t* task) {
 
     // 仅处理非删除状态的任务
     if (task->status != TASK_DELETED) {
+#if TM_CONFIG_READY_QUEUE
+        uint32_t irq_state = TM_CRITICAL_ENTER();
+        tm_list_remove(task);
+        task->status = TASK_SUSPENDED;
+        TM_CRITICAL_EXIT(irq_state);
+#else
         task->status = TASK_SUSPENDED;
+#endif
         return 0;
     }
 
@@ -185,202 +986,683 @@ uint8_t TaskManager_ResumeTask(TaskHandle_t* task) {
 
     // 仅处理挂起状态的任务
     if (task->status == TASK_SUSPENDED) {
-        task->status = TASK_READY;
         task->next_run_time = HAL_GetTick();  // 立即可运行
+#if TM_CONFIG_READY_QUEUE
+        uint32_t irq_state = TM_CRITICAL_ENTER();
+        tm_ready_add(task);
+        TM_CRITICAL_EXIT(irq_state);
+#else
+        task->status = TASK_READY;
+#endif
+        return 0;
+    }
+
+    return 2;  // 任务非挂起状态
+}
+
+/**
+ * @brief  设置任务周期
+ * @param  task: 任务句柄
+ * @param  period: 周期时间（ms）
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_SetTaskPeriod(TaskHandle_t* task, uint32_t period) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL) {
+        return 1;
+    }
+
+    // 设置周期
+    task->period = period;
+    return 0;
+}
+
+/**
+ * @brief  设置周期任务的重装方式和超期策略
+ * @param  task: 任务句柄
+ * @param  mode: 重装方式（固定间隔/固定速率）
+ * @param  policy: 固定速率模式下错过周期时的处理策略
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_SetTaskPeriodMode(TaskHandle_t* task, TaskPeriodMode mode, TaskOverrunPolicy policy) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL) {
+        return 1;
+    }
+
+    task->period_mode = mode;
+    task->overrun_policy = policy;
+    return 0;
+}
+
+/**
+ * @brief  设置任务优先级
+ * @param  task: 任务句柄
+ * @param  priority: 优先级（数值越小优先级越高）
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_SetTaskPriority(TaskHandle_t* task, uint32_t priority) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL) {
+        return 1;
+    }
+
+    // 设置优先级
+#if TM_CONFIG_READY_QUEUE
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    if (task->list_id == TM_LIST_READY) {
+        // 已在就绪桶中，需要迁移到新优先级对应的桶
+        tm_list_remove(task);
+        task->priority = priority;
+        tm_ready_add(task);
+    } else {
+        task->priority = priority;
+    }
+    TM_CRITICAL_EXIT(irq_state);
+#else
+    task->priority = priority;
+#endif
+    return 0;
+}
+
+/**
+ * @brief  任务延时
+ * @param  delay_ms: 延时时间（ms）
+ * @retval 无
+ * @note   仅在任务内部调用有效；延时在任务函数返回后生效，需在延时点继续执行请使用TM_DELAY()
+ */
+void TaskManager_Delay(uint32_t delay_ms) {
+    // 获取当前任务
+    TaskHandle_t* current_task = TaskManager_GetCurrentTask();
+    if (current_task == NULL) {
+        return;  // 不在任务上下文中
+    }
+
+    // 设置下次运行时间
+    current_task->next_run_time = HAL_GetTick() + delay_ms;
+
+    // 设置任务状态为阻塞状态
+#if TM_CONFIG_READY_QUEUE
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    tm_list_remove(current_task);
+    tm_delayed_add(current_task);
+    TM_CRITICAL_EXIT(irq_state);
+#else
+    current_task->status = TASK_BLOCKED;
+#endif
+
+    // 不在此处递归调用调度器：任务函数返回后调度器看到阻塞状态，不再重装周期，
+    // 延时到期前该任务不会再被分派
+}
+
+/**
+ * @brief  获取当前任务句柄
+ * @retval 当前任务句柄（NULL表示无任务运行）
+ */
+TaskHandle_t* TaskManager_GetCurrentTask(void) {
+    if (!g_task_manager.is_initialized || !TM_IS_SCHEDULING()) {
+        return NULL;
+    }
+
+    if (tm_current_task != NULL && tm_current_task->status != TASK_DELETED) {
+        return tm_current_task;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief  根据名称查找任务
+ * @param  name: 任务名称
+ * @retval 任务句柄（NULL表示未找到）
+ */
+TaskHandle_t* TaskManager_FindTaskByName(const char* name) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || name == NULL) {
+        return NULL;
+    }
+
+    // 只比较同一哈希桶中的任务
+    uint8_t slot = g_task_manager.name_hash[tm_name_hash(name)];
+    while (slot != TM_SLOT_NONE) {
+        TaskHandle_t* task = &g_task_manager.tasks[slot];
+        if (strcmp(task->name, name) == 0) {
+            return task;
+        }
+        slot = task->hash_next;
+    }
+
+    return NULL;  // 未找到任务
+}
+
+/**
+ * @brief  获取任务ID
+ * @param  task: 任务句柄
+ * @retval 任务ID（TASK_ID_INVALID表示任务无效）
+ */
+TaskId_t TaskManager_GetTaskId(TaskHandle_t* task) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || !tm_task_valid(task)) {
+        return TASK_ID_INVALID;
+    }
+
+    return (task->generation << TM_ID_SLOT_BITS) | task->slot;
+}
+
+/**
+ * @brief  根据任务ID获取任务句柄
+ * @param  id: 任务ID
+ * @retval 任务句柄（NULL表示任务已删除或ID无效）
+ */
+TaskHandle_t* TaskManager_GetTaskById(TaskId_t id) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || id == TASK_ID_INVALID) {
+        return NULL;
+    }
+
+    uint8_t slot = (uint8_t)(id & ((1U << TM_ID_SLOT_BITS) - 1));
+    if (slot >= g_task_manager.slot_top) {
+        return NULL;
+    }
+
+    // 代数不一致说明该任务已删除（槽位可能已被新任务复用）
+    TaskHandle_t* task = &g_task_manager.tasks[slot];
+    if (task->status == TASK_DELETED || task->generation != (id >> TM_ID_SLOT_BITS)) {
+        return NULL;
+    }
+
+    return task;
+}
+
+/**
+ * @brief  创建任务消息队列
+ * @param  task: 任务句柄
+ * @param  queue_size: 队列大小
+ * @param  msg_size: 消息大小
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_CreateTaskQueue(TaskHandle_t* task, uint16_t queue_size, uint16_t msg_size) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL) {
+        return 1;
+    }
+
+    // 如果已有队列，先释放
+    tm_queue_release(task);
+
+    // 分配并初始化队列
+    return tm_queue_alloc(task, queue_size, msg_size);
+}
+
+/**
+ * @brief  向任务发送消息
+ * @param  task: 目标任务句柄
+ * @param  msg: 消息数据
+ * @param  size: 消息大小
+ * @param  priority: 消息优先级
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_SendTaskMessage(TaskHandle_t* task, const void* msg, uint16_t size, uint32_t priority) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL || msg == NULL) {
+        return 1;
+    }
+
+    // 检查任务是否有消息队列
+    if (task->queue == NULL) {
+        return 2;  // 任务无消息队列
+    }
+
+    // 发送消息（可在中断中调用，与接收方互斥）
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    MSGQUEUE_Status status = MSGQUEUE_Send(task->queue, (const uint8_t*)msg, size, priority);
+    if (status != MSGQUEUE_OK) {
+        TM_CRITICAL_EXIT(irq_state);
+        return 3;  // 消息发送失败
+    }
+
+    // 接收任务正在等待消息时直接转为就绪
+    if (task->status == TASK_BLOCKED && task->wait_type == TM_WAITING_MSG) {
+        tm_wake_waiter(task);
+    }
+    TM_CRITICAL_EXIT(irq_state);
+
+    return 0;
+}
+
+/**
+ * @brief  从任务队列接收消息
+ * @param  task: 任务句柄
+ * @param  buffer: 接收缓冲区
+ * @param  size: 缓冲区大小
+ * @param  received_size: 实际接收大小
+ * @retval 0:成功 1:队列为空 其他:错误
+ */
+uint8_t TaskManager_ReceiveTaskMessage(TaskHandle_t* task, void* buffer, uint16_t size, uint16_t* received_size) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL || buffer == NULL) {
+        return 2;
+    }
+
+    // 检查任务是否有消息队列
+    if (task->queue == NULL) {
+        return 3;  // 任务无消息队列
+    }
+
+    // 接收消息
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    MSGQUEUE_Status status = MSGQUEUE_Receive(task->queue, (uint8_t*)buffer, size, received_size);
+    TM_CRITICAL_EXIT(irq_state);
+    if (status == MSGQUEUE_EMPTY) {
+        return 1;  // 队列为空
+    } else if (status != MSGQUEUE_OK) {
+        return 4;  // 消息接收失败
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  设置任务所属的互斥组
+ * @param  task: 任务句柄
+ * @param  group: 互斥组（1~32，0表示不属于任何组）
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_SetTaskGroup(TaskHandle_t* task, uint8_t group) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL || group > 32) {
+        return 1;
+    }
+
+    task->excl_group = group;
+    return 0;
+}
+
+/**
+ * @brief  设置主机多线程后端的工作线程数（需在TaskManager_StartScheduler()前调用）
+ * @param  count: 工作线程数（1~TM_CONFIG_HOST_MAX_WORKERS）
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_SetWorkerCount(uint8_t count) {
+#if TM_CONFIG_HOST_THREADS
+    // 参数检查
+    if (!g_task_manager.is_initialized || TM_IS_SCHEDULING() ||
+        count == 0 || count > TM_CONFIG_HOST_MAX_WORKERS) {
+        return 1;
+    }
+
+    g_task_manager.worker_count = count;
+    return 0;
+#else
+    (void)count;
+    return 2;  // 未启用主机多线程后端
+#endif
+}
+
+/**
+ * @brief  等待当前任务的消息队列中有消息
+ * @param  timeout: 超时时间（ms），TM_WAIT_FOREVER表示永久等待，0表示不等待
+ * @retval 0:已有消息 1:队列为空（timeout非0时任务已阻塞，应返回调度器） 其他:错误
+ */
+uint8_t TaskManager_WaitMessage(uint32_t timeout) {
+    // 获取当前任务
+    TaskHandle_t* task = TaskManager_GetCurrentTask();
+    if (task == NULL) {
+        return 2;  // 不在任务上下文中
+    }
+
+    // 检查任务是否有消息队列
+    if (task->queue == NULL) {
+        return 3;  // 任务无消息队列
+    }
+
+    // 判断与阻塞在同一临界区内完成，避免中断在两者之间投递消息导致唤醒丢失
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    if (!MSGQUEUE_IsEmpty(task->queue)) {
+        TM_CRITICAL_EXIT(irq_state);
         return 0;
     }
+    if (timeout != 0) {
+        tm_block_wait(task, TM_WAITING_MSG, timeout);
+    }
+    TM_CRITICAL_EXIT(irq_state);
 
-    return 2;  // 任务非挂起状态
+    return 1;
 }
 
 /**
- * @brief  设置任务周期
+ * @brief  设置任务事件标志（可在中断中调用）
  * @param  task: 任务句柄
- * @param  period: 周期时间（ms）
+ * @param  flags: 要置位的标志
  * @retval 0:成功 非0:失败
  */
-uint8_t TaskManager_SetTaskPeriod(TaskHandle_t* task, uint32_t period) {
+uint8_t TaskManager_SetEvents(TaskHandle_t* task, uint32_t flags) {
     // 参数检查
     if (!g_task_manager.is_initialized || task == NULL) {
         return 1;
     }
 
-    // 设置周期
-    task->period = period;
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    task->event_flags |= flags;
+    // 任务正在等待且条件已满足时转为就绪，标志由任务恢复后在WaitEvents中清除
+    if (task->status == TASK_BLOCKED && task->wait_type == TM_WAITING_EVENTS &&
+        tm_events_match(task->event_flags, task->wait_mask, task->wait_options) != 0) {
+        tm_wake_waiter(task);
+    }
+    TM_CRITICAL_EXIT(irq_state);
+
     return 0;
 }
 
 /**
- * @brief  设置任务优先级
+ * @brief  清除任务事件标志（可在中断中调用）
  * @param  task: 任务句柄
- * @param  priority: 优先级（数值越小优先级越高）
- * @retval 0:成功 非0:失败
+ * @param  flags: 要清除的标志
+ * @retval 清除前的事件标志
  */
-uint8_t TaskManager_SetTaskPriority(TaskHandle_t* task, uint32_t priority) {
+uint32_t TaskManager_ClearEvents(TaskHandle_t* task, uint32_t flags) {
     // 参数检查
     if (!g_task_manager.is_initialized || task == NULL) {
-        return 1;
+        return 0;
     }
 
-    // 设置优先级
-    task->priority = priority;
-    return 0;
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    uint32_t previous = task->event_flags;
+    task->event_flags &= ~flags;
+    TM_CRITICAL_EXIT(irq_state);
+
+    return previous;
 }
 
 /**
- * @brief  任务延时
- * @param  delay_ms: 延时时间（ms）
- * @retval 无
- * @note   仅在任务内部调用有效
+ * @brief  获取任务事件标志
+ * @param  task: 任务句柄
+ * @retval 当前事件标志
  */
-void TaskManager_Delay(uint32_t delay_ms) {
-    // 获取当前任务
-    TaskHandle_t* current_task = TaskManager_GetCurrentTask();
-    if (current_task == NULL) {
-        return;  // 不在任务上下文中
+uint32_t TaskManager_GetEvents(TaskHandle_t* task) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL) {
+        return 0;
     }
 
-    // 设置任务状态为阻塞状态
-    current_task->status = TASK_BLOCKED;
-    
-    // 设置下次运行时间
-    current_task->next_run_time = HAL_GetTick() + delay_ms;
-    
-    // 让出CPU时间
-    TaskManager_Schedule();
+    return task->event_flags;
 }
 
 /**
- * @brief  获取当前任务句柄
- * @retval 当前任务句柄（NULL表示无任务运行）
+ * @brief  等待当前任务的事件标志
+ * @param  mask: 等待的标志
+ * @param  options: TM_EVENT_WAIT_ANY/TM_EVENT_WAIT_ALL，可或上TM_EVENT_NO_CLEAR
+ * @param  timeout: 超时时间（ms），TM_WAIT_FOREVER表示永久等待，0表示不等待
+ * @retval 满足条件时返回匹配的标志；不满足或mask为0时返回0（timeout非0且mask非0时任务已阻塞，应返回调度器）
  */
-TaskHandle_t* TaskManager_GetCurrentTask(void) {
-    if (!g_task_manager.is_initialized || !g_task_manager.is_scheduling) {
-        return NULL;
+uint32_t TaskManager_WaitEvents(uint32_t mask, uint8_t options, uint32_t timeout) {
+    // 获取当前任务
+    TaskHandle_t* task = TaskManager_GetCurrentTask();
+    if (task == NULL || mask == 0) {
+        return 0;
     }
 
-    if (g_task_manager.current_task_index < g_task_manager.task_count) {
-        return &g_task_manager.tasks[g_task_manager.current_task_index];
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    uint32_t matched = tm_events_match(task->event_flags, mask, options);
+    if (matched != 0) {
+        if ((options & TM_EVENT_NO_CLEAR) == 0) {
+            task->event_flags &= ~matched;
+        }
+    } else if (timeout != 0) {
+        task->wait_mask = mask;
+        task->wait_options = options;
+        tm_block_wait(task, TM_WAITING_EVENTS, timeout);
     }
+    TM_CRITICAL_EXIT(irq_state);
 
-    return NULL;
+    return matched;
 }
 
-/**
- * @brief  根据名称查找任务
- * @param  name: 任务名称
- * @retval 任务句柄（NULL表示未找到）
- */
-TaskHandle_t* TaskManager_FindTaskByName(const char* name) {
-    // 参数检查
-    if (!g_task_manager.is_initialized || name == NULL) {
-        return NULL;
+/* 分派前更新任务状态和统计信息，返回任务本次的应运行时间（超时唤醒的等待在此结束） */
+static uint32_t tm_dispatch_begin(TaskHandle_t* task, uint32_t current_time) {
+    uint32_t release_time = task->next_run_time;
+    task->status = TASK_RUNNING;
+    task->wait_type = TM_WAITING_NONE;
+    task->wait_forever = 0;
+    task->run_count++;
+    g_task_manager.task_switch_count++;
+    if (task->period > 0) {
+        tm_record_lateness(task, current_time, release_time);
     }
+    return release_time;
+}
 
-    // 遍历任务数组
-    for (uint8_t i = 0; i < g_task_manager.task_count; i++) {
-        if (strcmp(g_task_manager.tasks[i].name, name) == 0) {
-            return &g_task_manager.tasks[i];
-        }
+/* 执行任务函数 */
+static void tm_dispatch_run(TaskHandle_t* task) {
+#if TM_CONFIG_PROFILING
+    uint32_t start_cycles = tm_read_cycles();
+    task->function(task->param);
+    tm_record_exec(task, tm_read_cycles() - start_cycles);
+#else
+    task->function(task->param);
+#endif
+}
+
+/* 任务函数返回后重新排队：周期任务进入唤醒堆，其他任务回到就绪状态 */
+static void tm_dispatch_end(TaskHandle_t* task, uint32_t current_time, uint32_t release_time) {
+    if (task->status != TASK_RUNNING) {  // 任务内部已改变状态（延时/等待/挂起/删除）
+        return;
     }
 
-    return NULL;  // 未找到任务
+    if (task->period > 0) {
+        // 周期性任务，设置下次运行时间
+        task->next_run_time = tm_next_release(task, current_time, release_time);
+#if TM_CONFIG_READY_QUEUE
+        tm_delayed_add(task);
+#else
+        task->status = TASK_BLOCKED;
+#endif
+    } else {
+        // 非周期性任务，任务运行结束后回到就绪状态（同优先级任务轮转）
+#if TM_CONFIG_READY_QUEUE
+        tm_ready_add(task);
+#else
+        task->status = TASK_READY;
+#endif
+    }
 }
 
-/**
- * @brief  创建任务消息队列
- * @param  task: 任务句柄
- * @param  queue_size: 队列大小
- * @param  msg_size: 消息大小
- * @retval 0:成功 非0:失败
- */
-uint8_t TaskManager_CreateTaskQueue(TaskHandle_t* task, uint16_t queue_size, uint16_t msg_size) {
-    // 参数检查
-    if (!g_task_manager.is_initialized || task == NULL) {
-        return 1;
+#if TM_CONFIG_HOST_THREADS
+/* 工作线程本地队列中的一项：已取出并标记为运行状态的任务 */
+typedef struct {
+    TaskHandle_t* task;             // 任务
+    uint32_t generation;            // 取出时的槽位代数（执行前校验任务未被删除）
+    uint32_t dispatch_time;         // 分派时间
+    uint32_t release_time;          // 应运行时间
+    uint8_t group;                  // 取出时占用的互斥组
+} TmWorkItem_t;
+
+/* 工作线程本地队列：所有者从头部按优先级顺序取，其他线程从尾部窃取 */
+typedef struct {
+    pthread_mutex_t lock;
+    TmWorkItem_t items[TM_CONFIG_HOST_BATCH];
+    uint8_t head;
+    uint8_t count;
+} TmWorkerQueue_t;
+
+static TmWorkerQueue_t tm_worker_queues[TM_CONFIG_HOST_MAX_WORKERS];
+
+/* 从本地队列头部取出一项 */
+static uint8_t tm_worker_pop(TmWorkerQueue_t* queue, TmWorkItem_t* item) {
+    uint8_t found = 0;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0) {
+        *item = queue->items[queue->head];
+        queue->head = (uint8_t)((queue->head + 1) % TM_CONFIG_HOST_BATCH);
+        queue->count--;
+        found = 1;
     }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
 
-    // 如果已有队列，先释放
-    if (task->queue != NULL) {
-        MSGQUEUE_Deinit(task->queue);
-        free(task->queue);
-        task->queue = NULL;
+/* 从其他工作线程的本地队列尾部窃取一项 */
+static uint8_t tm_worker_steal(uint8_t self, TmWorkItem_t* item) {
+    for (uint8_t i = 1; i < g_task_manager.worker_count; i++) {
+        TmWorkerQueue_t* victim = &tm_worker_queues[(self + i) % g_task_manager.worker_count];
+        uint8_t found = 0;
+        pthread_mutex_lock(&victim->lock);
+        if (victim->count > 0) {
+            victim->count--;
+            *item = victim->items[(victim->head + victim->count) % TM_CONFIG_HOST_BATCH];
+            found = 1;
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (found) {
+            return 1;
+        }
     }
+    return 0;
+}
 
-    // 分配队列内存
-    task->queue = (MSGQUEUE_HandleTypeDef*)malloc(sizeof(MSGQUEUE_HandleTypeDef));
-    if (task->queue == NULL) {
-        return 2;  // 内存分配失败
+/* 持全局锁从就绪队列批量取出任务：第一个返回给调用者，其余放入本地队列；没有可运行任务时等待 */
+static uint8_t tm_worker_refill(uint8_t self, TmWorkItem_t* item) {
+    uint8_t taken = 0;
+    TmWorkerQueue_t* queue = &tm_worker_queues[self];
+
+    TM_Host_Lock();
+    uint32_t current_time = HAL_GetTick();
+    tm_update_load(current_time);
+    tm_wake_expired(current_time);
+
+    // 按优先级顺序原地遍历就绪桶：空闲任务不占用工作线程，互斥组已被占用的任务留在原位并跳过，
+    // 不会因为前面排着被阻止的任务而取不到后面可运行的任务
+    uint32_t pending = g_task_manager.ready_bitmap;
+    while (taken < TM_CONFIG_HOST_BATCH && pending != 0) {
+        uint32_t bucket = tm_find_first_set(pending);
+        pending &= ~(1UL << bucket);
+
+        TaskHandle_t* next = NULL;
+        for (TaskHandle_t* task = g_task_manager.ready_lists[bucket].head;
+             task != NULL && taken < TM_CONFIG_HOST_BATCH; task = next) {
+            next = task->list_next;
+            uint32_t group_bit = (task->excl_group != 0) ? (1UL << (task->excl_group - 1)) : 0;
+            if (task->function == idle_task || (g_task_manager.group_busy & group_bit) != 0) {
+                continue;
+            }
+
+            tm_list_remove(task);
+            g_task_manager.group_busy |= group_bit;
+            TmWorkItem_t work;
+            work.task = task;
+            work.generation = task->generation;
+            work.dispatch_time = current_time;
+            work.release_time = tm_dispatch_begin(task, current_time);
+            work.group = task->excl_group;
+
+            if (taken == 0) {
+                *item = work;
+            } else {
+                pthread_mutex_lock(&queue->lock);
+                queue->items[(queue->head + queue->count) % TM_CONFIG_HOST_BATCH] = work;
+                queue->count++;
+                pthread_mutex_unlock(&queue->lock);
+            }
+            taken++;
+        }
     }
 
-    // 初始化队列
-    MSGQUEUE_Status status = MSGQUEUE_Init(task->queue, queue_size, msg_size);
-    if (status != MSGQUEUE_OK) {
-        free(task->queue);
-        task->queue = NULL;
-        return 3;  // 队列初始化失败
+    if (taken == 0 && TM_IS_SCHEDULING()) {
+        // 没有可运行任务：等待任务就绪/互斥组释放，最多1ms后重新检查唤醒堆
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        g_task_manager.idle_count++;
+        pthread_cond_timedwait(&tm_host_cond, &tm_host_mutex, &deadline);
     }
+    TM_Host_Unlock(0);
 
-    return 0;
+    return taken > 0;
 }
 
-/**
- * @brief  向任务发送消息
- * @param  task: 目标任务句柄
- * @param  msg: 消息数据
- * @param  size: 消息大小
- * @param  priority: 消息优先级
- * @retval 0:成功 非0:失败
- */
-uint8_t TaskManager_SendTaskMessage(TaskHandle_t* task, const void* msg, uint16_t size, uint32_t priority) {
-    // 参数检查
-    if (!g_task_manager.is_initialized || task == NULL || msg == NULL) {
-        return 1;
+/* 执行一项任务并重新排队，释放其互斥组 */
+static void tm_worker_execute(TmWorkItem_t* item) {
+    TaskHandle_t* task = item->task;
+
+    // 取出后被删除（槽位可能已被新任务复用）的任务不再执行；状态与代数由其他线程在锁内修改，须持锁读取
+    TM_Host_Lock();
+    uint8_t runnable = (task->generation == item->generation && task->status == TASK_RUNNING);
+    TM_Host_Unlock(0);
+    if (runnable) {
+        tm_current_task = task;
+        tm_dispatch_run(task);
+        tm_current_task = NULL;
     }
 
-    // 检查任务是否有消息队列
-    if (task->queue == NULL) {
-        return 2;  // 任务无消息队列
+    TM_Host_Lock();
+    if (task->generation == item->generation) {
+        tm_dispatch_end(task, item->dispatch_time, item->release_time);
+    }
+    if (item->group != 0) {
+        g_task_manager.group_busy &= ~(1UL << (item->group - 1));
+        pthread_cond_broadcast(&tm_host_cond);
     }
+    TM_Host_Unlock(0);
+}
 
-    // 发送消息
-    MSGQUEUE_Status status = MSGQUEUE_Send(task->queue, (const uint8_t*)msg, size, priority);
-    if (status != MSGQUEUE_OK) {
-        return 3;  // 消息发送失败
+/* 工作线程主循环：本地队列 -> 窃取 -> 从就绪队列批量取 */
+static void* tm_worker_main(void* arg) {
+    uint8_t self = (uint8_t)(uintptr_t)arg;
+    TmWorkItem_t item;
+
+    while (TM_IS_SCHEDULING()) {
+        if (tm_worker_pop(&tm_worker_queues[self], &item) ||
+            tm_worker_steal(self, &item) ||
+            tm_worker_refill(self, &item)) {
+            tm_worker_execute(&item);
+        }
     }
 
-    return 0;
+    // 退出前把本地队列中未执行的任务放回就绪队列
+    while (tm_worker_pop(&tm_worker_queues[self], &item)) {
+        TM_Host_Lock();
+        if (item.task->generation == item.generation && item.task->status == TASK_RUNNING) {
+            tm_ready_add(item.task);
+        }
+        if (item.group != 0) {
+            g_task_manager.group_busy &= ~(1UL << (item.group - 1));
+        }
+        TM_Host_Unlock(0);
+    }
+    return NULL;
 }
 
-/**
- * @brief  从任务队列接收消息
- * @param  task: 任务句柄
- * @param  buffer: 接收缓冲区
- * @param  size: 缓冲区大小
- * @param  received_size: 实际接收大小
- * @retval 0:成功 1:队列为空 其他:错误
- */
-uint8_t TaskManager_ReceiveTaskMessage(TaskHandle_t* task, void* buffer, uint16_t size, uint16_t* received_size) {
-    // 参数检查
-    if (!g_task_manager.is_initialized || task == NULL || buffer == NULL) {
-        return 2;
+/* 启动工作线程池并等待调度停止 */
+static void tm_host_run(void) {
+    pthread_t threads[TM_CONFIG_HOST_MAX_WORKERS];
+    uint8_t started = 0;
+
+    for (uint8_t i = 0; i < g_task_manager.worker_count; i++) {
+        pthread_mutex_init(&tm_worker_queues[i].lock, NULL);
+        tm_worker_queues[i].head = 0;
+        tm_worker_queues[i].count = 0;
     }
 
-    // 检查任务是否有消息队列
-    if (task->queue == NULL) {
-        return 3;  // 任务无消息队列
+    for (uint8_t i = 0; i < g_task_manager.worker_count; i++) {
+        if (pthread_create(&threads[i], NULL, tm_worker_main, (void*)(uintptr_t)i) != 0) {
+            break;
+        }
+        started++;
     }
 
-    // 接收消息
-    MSGQUEUE_Status status = MSGQUEUE_Receive(task->queue, (uint8_t*)buffer, size, received_size);
-    if (status == MSGQUEUE_EMPTY) {
-        return 1;  // 队列为空
-    } else if (status != MSGQUEUE_OK) {
-        return 4;  // 消息接收失败
+    for (uint8_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
     }
 
-    return 0;
+    for (uint8_t i = 0; i < g_task_manager.worker_count; i++) {
+        pthread_mutex_destroy(&tm_worker_queues[i].lock);
+    }
 }
+#endif /* TM_CONFIG_HOST_THREADS */
 
 /**
  * @brief  任务调度器
@@ -388,33 +1670,49 @@ uint8_t TaskManager_ReceiveTaskMessage(TaskHandle_t* task, void* buffer, uint16_
  */
 void TaskManager_Schedule(void) {
     // 参数检查
-    if (!g_task_manager.is_initialized || !g_task_manager.is_scheduling) {
+    if (!g_task_manager.is_initialized || !TM_IS_SCHEDULING()) {
         return;
     }
 
     TaskHandle_t* task = NULL;
-    uint8_t task_found = 0;
     uint32_t current_time = HAL_GetTick();
+
+    tm_update_load(current_time);
+
+#if TM_CONFIG_READY_QUEUE
+    // 唤醒到期的阻塞任务，然后从最高优先级的非空就绪桶中取出队首任务
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    tm_wake_expired(current_time);
+    task = tm_pick_next();
+    if (task == NULL) {
+        TM_CRITICAL_EXIT(irq_state);
+        return;
+    }
+    uint32_t release_time = tm_dispatch_begin(task, current_time);
+    TM_CRITICAL_EXIT(irq_state);
+    g_task_manager.current_task_index = task->slot;
+#else
+    uint8_t task_found = 0;
     uint32_t lowest_priority = 0xFFFFFFFF;
     uint8_t next_task_index = 0;
 
     // 找到可运行的最高优先级（数值最小）任务
-    for (uint8_t i = 0; i < g_task_manager.task_count; i++) {
+    for (uint8_t i = 0; i < g_task_manager.slot_top; i++) {
         task = &g_task_manager.tasks[i];
 
         // 检查任务状态
         if (task->status == TASK_READY) {
-            // 就绪状态，直接检查优先级
-            if (task->priority < lowest_priority) {
+            // 就绪状态，直接检查优先级（空闲任务优先级为0xFFFFFFFF，仅在无其他任务时选中）
+            if (!task_found || task->priority < lowest_priority) {
                 lowest_priority = task->priority;
                 next_task_index = i;
                 task_found = 1;
             }
-        } else if (task->status == TASK_BLOCKED) {
-            // 阻塞状态，检查是否已到运行时间
-            if (current_time >= task->next_run_time) {
+        } else if (task->status == TASK_BLOCKED && !task->wait_forever) {
+            // 阻塞状态，检查是否已到运行时间（永久等待消息/事件的任务只由发送方唤醒）
+            if (TM_TIME_AFTER_EQ(current_time, task->next_run_time)) {
                 task->status = TASK_READY;  // 恢复就绪状态
-                if (task->priority < lowest_priority) {
+                if (!task_found || task->priority < lowest_priority) {
                     lowest_priority = task->priority;
                     next_task_index = i;
                     task_found = 1;
@@ -423,31 +1721,26 @@ void TaskManager_Schedule(void) {
         }
     }
 
-    // 如果找到可运行任务，执行它
-    if (task_found) {
-        g_task_manager.current_task_index = next_task_index;
-        task = &g_task_manager.tasks[next_task_index];
-        
-        // 更新任务状态和统计信息
-        task->status = TASK_RUNNING;
-        task->run_count++;
-        g_task_manager.task_switch_count++;
-        
-        // 执行任务函数
-        task->function(task->param);
-        
-        // 更新任务状态
-        if (task->status == TASK_RUNNING) {  // 如果任务内部没有改变状态
-            if (task->period > 0) {
-                // 周期性任务，设置下次运行时间
-                task->next_run_time = current_time + task->period;
-                task->status = TASK_BLOCKED;
-            } else {
-                // 非周期性任务，任务运行结束后回到就绪状态
-                task->status = TASK_READY;
-            }
-        }
+    // 没有可运行任务
+    if (!task_found) {
+        return;
     }
+    g_task_manager.current_task_index = next_task_index;
+    task = &g_task_manager.tasks[next_task_index];
+    uint32_t release_time = tm_dispatch_begin(task, current_time);
+#endif
+
+    // 执行任务函数
+    tm_current_task = task;
+    tm_dispatch_run(task);
+
+#if TM_CONFIG_READY_QUEUE
+    irq_state = TM_CRITICAL_ENTER();
+    tm_dispatch_end(task, current_time, release_time);
+    TM_CRITICAL_EXIT(irq_state);
+#else
+    tm_dispatch_end(task, current_time, release_time);
+#endif
 }
 
 /**
@@ -461,12 +1754,17 @@ void TaskManager_StartScheduler(void) {
     }
 
     // 启动调度器
-    g_task_manager.is_scheduling = 1;
-    
+    TM_SET_SCHEDULING(1);
+
+#if TM_CONFIG_HOST_THREADS
+    // 工作线程池并行执行就绪任务，直到TaskManager_StopScheduler()
+    tm_host_run();
+#else
     // 主循环调度任务
-    while (g_task_manager.is_scheduling) {
+    while (TM_IS_SCHEDULING()) {
         TaskManager_Schedule();
     }
+#endif
 }
 
 /**
@@ -474,7 +1772,13 @@ void TaskManager_StartScheduler(void) {
  * @retval 无
  */
 void TaskManager_StopScheduler(void) {
-    g_task_manager.is_scheduling = 0;
+    TM_SET_SCHEDULING(0);
+#if TM_CONFIG_HOST_THREADS
+    // 唤醒正在等待的工作线程，使其退出
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    pthread_cond_broadcast(&tm_host_cond);
+    TM_CRITICAL_EXIT(irq_state);
+#endif
 }
 
 /**
@@ -492,6 +1796,60 @@ void TaskManager_GetTaskStats(TaskHandle_t* task, uint32_t* run_count) {
     *run_count = task->run_count;
 }
 
+/**
+ * @brief  获取任务扩展统计信息（运行次数、分派延迟、错过/跳过的周期数）
+ * @param  task: 任务句柄
+ * @param  stats: 统计信息输出
+ * @retval 无
+ */
+void TaskManager_GetTaskStatsEx(TaskHandle_t* task, TaskStatistics_t* stats) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL || stats == NULL) {
+        return;
+    }
+
+    stats->run_count = task->run_count;
+    stats->last_lateness = task->last_lateness;
+    stats->max_lateness = task->max_lateness;
+    stats->missed_count = task->missed_count;
+    stats->skipped_count = task->skipped_count;
+#if TM_CONFIG_PROFILING
+    stats->exec_last = task->exec_last;
+    stats->exec_min = task->exec_min;
+    stats->exec_max = task->exec_max;
+    stats->exec_avg = (task->run_count > 0) ? (uint32_t)(task->exec_total / task->run_count) : 0;
+#else
+    stats->exec_last = 0;
+    stats->exec_min = 0;
+    stats->exec_max = 0;
+    stats->exec_avg = 0;
+#endif
+}
+
+/**
+ * @brief  清零任务统计信息
+ * @param  task: 任务句柄
+ * @retval 无
+ */
+void TaskManager_ResetTaskStats(TaskHandle_t* task) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || task == NULL) {
+        return;
+    }
+
+    task->run_count = 0;
+    task->last_lateness = 0;
+    task->max_lateness = 0;
+    task->missed_count = 0;
+    task->skipped_count = 0;
+#if TM_CONFIG_PROFILING
+    task->exec_last = 0;
+    task->exec_min = 0;
+    task->exec_max = 0;
+    task->exec_total = 0;
+#endif
+}
+
 /**
  * @brief  获取系统统计信息
  * @param  task_switch_count: 任务切换次数
@@ -513,6 +1871,183 @@ void TaskManager_GetSystemStats(uint32_t* task_switch_count, uint32_t* idle_coun
     }
 }
 
+/**
+ * @brief  获取内存使用及高水位统计
+ * @param  stats: 统计信息输出
+ * @retval 无
+ */
+void TaskManager_GetMemStats(TaskManager_MemStats_t* stats) {
+    // 参数检查
+    if (!g_task_manager.is_initialized || stats == NULL) {
+        return;
+    }
+
+    stats->task_capacity = g_task_manager.max_tasks;
+    stats->task_count = g_task_manager.task_count;
+    stats->task_peak = g_task_manager.task_peak;
+#if TM_CONFIG_READY_QUEUE
+    stats->delay_peak = g_task_manager.delay_peak;
+#else
+    stats->delay_peak = 0;
+#endif
+    stats->queue_bytes_capacity = g_task_manager.queue_arena_size;
+    stats->queue_bytes_used = g_task_manager.queue_arena_used;
+    stats->queue_bytes_peak = g_task_manager.queue_arena_peak;
+}
+
+/**
+ * @brief  获取CPU负载估计
+ * @retval 上一统计窗口的CPU负载（0~100%）
+ */
+uint8_t TaskManager_GetCpuLoad(void) {
+    return g_task_manager.cpu_load;
+}
+
+/**
+ * @brief  设置满空闲（0%负载）时单个统计窗口内的空闲计数参考值
+ * @param  idle_per_window: 参考空闲计数，0表示恢复自动学习
+ * @retval 无
+ */
+void TaskManager_SetIdleReference(uint32_t idle_per_window) {
+    tm_idle_reference = idle_per_window;
+}
+
+/**
+ * @brief  设置执行时间统计使用的周期计数器
+ * @param  counter: 计数器读取函数，NULL表示不统计
+ * @retval 无
+ */
+void TaskManager_SetCycleCounter(TaskCycleCounter_t counter) {
+#if TM_CONFIG_PROFILING
+    tm_cycle_counter = counter;
+#else
+    (void)counter;
+#endif
+}
+
+/**
+ * @brief  设置低功耗空闲的睡眠函数（需启用TM_CONFIG_TICKLESS）
+ * @param  hook: 睡眠函数，NULL表示空闲时不睡眠
+ * @retval 无
+ */
+void TaskManager_SetSleepHook(TaskSleepHook_t hook) {
+#if TM_CONFIG_TICKLESS
+    tm_sleep_hook = hook;
+#else
+    (void)hook;
+#endif
+}
+
+/**
+ * @brief  获取低功耗空闲统计
+ * @param  sleep_ms: 累计睡眠时间输出（ms，可为NULL）
+ * @param  sleep_count: 睡眠次数输出（可为NULL）
+ * @retval 无
+ */
+void TaskManager_GetSleepStats(uint32_t* sleep_ms, uint32_t* sleep_count) {
+    if (sleep_ms != NULL) {
+        *sleep_ms = g_task_manager.sleep_total_ms;
+    }
+    if (sleep_count != NULL) {
+        *sleep_count = g_task_manager.sleep_count;
+    }
+}
+
+/* 任务状态的简短名称 */
+static const char* tm_status_name(TaskStatus status) {
+    switch (status) {
+        case TASK_READY:     return "READY";
+        case TASK_RUNNING:   return "RUN";
+        case TASK_BLOCKED:   return "BLOCK";
+        case TASK_SUSPENDED: return "SUSP";
+        default:             return "DEL";
+    }
+}
+
+/**
+ * @brief  以类似top的表格输出系统负载和各任务统计信息（通过TM_PRINTF）
+ * @retval 无
+ */
+void TaskManager_DumpStats(void) {
+    // 参数检查
+    if (!g_task_manager.is_initialized) {
+        return;
+    }
+
+    TM_PRINTF("CPU: %3u%%  tasks: %u/%u  switches: %lu  idle: %lu\r\n",
+              (unsigned)g_task_manager.cpu_load,
+              (unsigned)g_task_manager.task_count, (unsigned)g_task_manager.max_tasks,
+              (unsigned long)g_task_manager.task_switch_count,
+              (unsigned long)g_task_manager.idle_count);
+    if (g_task_manager.sleep_count > 0) {
+        TM_PRINTF("SLEEP: %lu ms in %lu sleeps\r\n",
+                  (unsigned long)g_task_manager.sleep_total_ms,
+                  (unsigned long)g_task_manager.sleep_count);
+    }
+    if (g_task_manager.is_static) {
+        TM_PRINTF("POOL: tasks peak %u/%u  queue bytes %lu/%lu (peak %lu)\r\n",
+                  (unsigned)g_task_manager.task_peak, (unsigned)g_task_manager.max_tasks,
+                  (unsigned long)g_task_manager.queue_arena_used,
+                  (unsigned long)g_task_manager.queue_arena_size,
+                  (unsigned long)g_task_manager.queue_arena_peak);
+    }
+
+#if TM_CONFIG_PROFILING
+    // 所有任务累计执行周期，用于计算各任务占比
+    uint64_t total_cycles = 0;
+    for (uint8_t i = 0; i < g_task_manager.slot_top; i++) {
+        if (g_task_manager.tasks[i].status != TASK_DELETED) {
+            total_cycles += g_task_manager.tasks[i].exec_total;
+        }
+    }
+
+    TM_PRINTF("%-15s %10s %-5s %8s %6s %9s %9s %9s %9s %6s %5s\r\n",
+              "NAME", "PRI", "STATE", "RUNS", "%CPU", "LAST", "MIN", "MAX", "AVG", "LATE", "MISS");
+#else
+    TM_PRINTF("%-15s %10s %-5s %8s %6s %6s %5s %5s\r\n",
+              "NAME", "PRI", "STATE", "RUNS", "LATE", "MAXLT", "MISS", "SKIP");
+#endif
+
+    for (uint8_t i = 0; i < g_task_manager.slot_top; i++) {
+        TaskHandle_t* task = &g_task_manager.tasks[i];
+        if (task->status == TASK_DELETED) {
+            continue;
+        }
+#if TM_CONFIG_PROFILING
+        uint32_t share = (total_cycles > 0) ? (uint32_t)(task->exec_total * 1000 / total_cycles) : 0;
+        uint32_t avg = (task->run_count > 0) ? (uint32_t)(task->exec_total / task->run_count) : 0;
+        TM_PRINTF("%-15s %10lu %-5s %8lu %4lu.%lu %9lu %9lu %9lu %9lu %6lu %5lu\r\n",
+                  task->name, (unsigned long)task->priority, tm_status_name(task->status),
+                  (unsigned long)task->run_count,
+                  (unsigned long)(share / 10), (unsigned long)(share % 10),
+                  (unsigned long)task->exec_last, (unsigned long)task->exec_min,
+                  (unsigned long)task->exec_max, (unsigned long)avg,
+                  (unsigned long)task->max_lateness, (unsigned long)task->missed_count);
+#else
+        TM_PRINTF("%-15s %10lu %-5s %8lu %6lu %6lu %5lu %5lu\r\n",
+                  task->name, (unsigned long)task->priority, tm_status_name(task->status),
+                  (unsigned long)task->run_count,
+                  (unsigned long)task->last_lateness, (unsigned long)task->max_lateness,
+                  (unsigned long)task->missed_count, (unsigned long)task->skipped_count);
+#endif
+    }
+
+#if MSGQUEUE_CONFIG_STATS
+    // 任务消息队列：按高水位和丢弃数调整队列容量
+    for (uint8_t i = 0; i < g_task_manager.slot_top; i++) {
+        TaskHandle_t* task = &g_task_manager.tasks[i];
+        MSGQUEUE_Stats qs;
+        if (task->status == TASK_DELETED || task->queue == NULL || MSGQUEUE_GetStats(task->queue, &qs) != MSGQUEUE_OK) {
+            continue;
+        }
+        TM_PRINTF("QUEUE %-15s hw %u/%u  sent %lu  drops %lu  trunc %lu  latency avg %lu max %lu ms\r\n",
+                  task->name, (unsigned)qs.high_water, (unsigned)task->queue->capacity,
+                  (unsigned long)qs.sent, (unsigned long)qs.drops, (unsigned long)qs.truncations,
+                  (unsigned long)qs.latency_avg, (unsigned long)qs.latency_max);
+    }
+#endif
+}
+
 /**
  * @brief  任务管理器周期性更新（在systick中断中调用）
  * @retval 无
@@ -523,14 +2058,23 @@ void TaskManager_Update(void) {
         return;
     }
 
-    // 遍历所有任务，更新阻塞任务状态
     uint32_t current_time = HAL_GetTick();
-    for (uint8_t i = 0; i < g_task_manager.task_count; i++) {
+
+#if TM_CONFIG_READY_QUEUE
+    // 唤醒堆按唤醒时间排序，只处理已到期的任务
+    uint32_t irq_state = TM_CRITICAL_ENTER();
+    tm_wake_expired(current_time);
+    TM_CRITICAL_EXIT(irq_state);
+#else
+    // 遍历所有任务，更新阻塞任务状态
+    for (uint8_t i = 0; i < g_task_manager.slot_top; i++) {
         TaskHandle_t* task = &g_task_manager.tasks[i];
-        
+
         // 检查阻塞任务是否到期
-        if (task->status == TASK_BLOCKED && current_time >= task->next_run_time) {
+        if (task->status == TASK_BLOCKED && !task->wait_forever &&
+            TM_TIME_AFTER_EQ(current_time, task->next_run_time)) {
             task->status = TASK_READY;
         }
     }
-} 
\ No newline at end of file
+#endif
+}
\ No newline at end of file
@@ -2,12 +2,140 @@
 #define __TASKMANAGER_H
 
 #include "main.h"
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
 /* 可选：使用消息队列进行任务间通信 */
 #include "msgqueue.h"
 
+/* 配置选项 */
+
+/* 调度模式：1=按优先级分桶的就绪链表+位图（选取任务O(1)），0=线性扫描任务数组 */
+#ifndef TM_CONFIG_READY_QUEUE
+#define TM_CONFIG_READY_QUEUE       1
+#endif
+
+/* 就绪链表优先级桶数量（最大32），优先级数值不小于(桶数-1)的任务共用最后一个桶（桶内按优先级数值排序） */
+#ifndef TM_CONFIG_PRIO_LEVELS
+#define TM_CONFIG_PRIO_LEVELS       32
+#endif
+
+#if (TM_CONFIG_PRIO_LEVELS < 1) || (TM_CONFIG_PRIO_LEVELS > 32)
+#error "TM_CONFIG_PRIO_LEVELS must be in range 1..32"
+#endif
+
+/* 任务执行时间统计：1=在任务函数前后读取周期计数器，统计最短/最长/平均/最近一次执行周期数 */
+#ifndef TM_CONFIG_PROFILING
+#define TM_CONFIG_PROFILING         0
+#endif
+
+/* CPU负载统计窗口（ms） */
+#ifndef TM_CONFIG_LOAD_WINDOW_MS
+#define TM_CONFIG_LOAD_WINDOW_MS    1000
+#endif
+
+/* TaskManager_DumpStats() 使用的输出函数 */
+#ifndef TM_PRINTF
+#define TM_PRINTF                   printf
+#endif
+
+/* 1=只允许使用 TaskManager_InitStatic() 静态任务池，编译时去掉所有堆分配路径 */
+#ifndef TM_CONFIG_STATIC_ONLY
+#define TM_CONFIG_STATIC_ONLY       0
+#endif
+
+/* 1=任务消息队列按消息优先级出队，0=严格按发送顺序出队（priority参数只被记录）
+   注意消息优先级沿用MSGQUEUE的约定：数值越大越先被接收，同优先级先进先出；
+   与任务优先级（数值越小优先级越高）相反 */
+#ifndef TM_CONFIG_QUEUE_PRIORITY
+#define TM_CONFIG_QUEUE_PRIORITY    1
+#endif
+
+/* 任务名称哈希桶数量（2的幂），FindTaskByName() 平均只比较 任务数/桶数 个名称 */
+#ifndef TM_CONFIG_NAME_HASH_SIZE
+#define TM_CONFIG_NAME_HASH_SIZE    16
+#endif
+
+#if (TM_CONFIG_NAME_HASH_SIZE < 1) || (TM_CONFIG_NAME_HASH_SIZE > 256) || \
+    ((TM_CONFIG_NAME_HASH_SIZE & (TM_CONFIG_NAME_HASH_SIZE - 1)) != 0)
+#error "TM_CONFIG_NAME_HASH_SIZE must be a power of two in range 1..256"
+#endif
+
+/* 低功耗空闲：1=没有就绪任务时由空闲任务调用睡眠函数，睡到最早的唤醒时间或被中断唤醒 */
+#ifndef TM_CONFIG_TICKLESS
+#define TM_CONFIG_TICKLESS          0
+#endif
+
+/* 距下次唤醒不足该时间（ms）时不睡眠，避免睡眠进出开销大于收益 */
+#ifndef TM_CONFIG_TICKLESS_MIN_MS
+#define TM_CONFIG_TICKLESS_MIN_MS   2
+#endif
+
+#if TM_CONFIG_TICKLESS_MIN_MS < 1
+#error "TM_CONFIG_TICKLESS_MIN_MS must be at least 1"
+#endif
+
+/* 单次睡眠最长时间（ms），所有任务都在永久等待时也按此时间醒来一次 */
+#ifndef TM_CONFIG_TICKLESS_MAX_MS
+#define TM_CONFIG_TICKLESS_MAX_MS   1000
+#endif
+
+/* 主机多线程后端（仅Linux/POSIX主机构建）：1=TaskManager_StartScheduler() 用pthread工作线程池并行执行就绪任务 */
+#ifndef TM_CONFIG_HOST_THREADS
+#define TM_CONFIG_HOST_THREADS      0
+#endif
+
+/* 默认工作线程数 */
+#ifndef TM_CONFIG_HOST_WORKERS
+#define TM_CONFIG_HOST_WORKERS      4
+#endif
+
+/* 最大工作线程数 */
+#ifndef TM_CONFIG_HOST_MAX_WORKERS
+#define TM_CONFIG_HOST_MAX_WORKERS  16
+#endif
+
+/* 工作线程每次从就绪队列批量取出的任务数（本地队列容量） */
+#ifndef TM_CONFIG_HOST_BATCH
+#define TM_CONFIG_HOST_BATCH        4
+#endif
+
+#if TM_CONFIG_HOST_THREADS && !TM_CONFIG_READY_QUEUE
+#error "TM_CONFIG_HOST_THREADS requires TM_CONFIG_READY_QUEUE"
+#endif
+
+/* 协程 TM_WAIT_UNTIL() 条件不成立时的重新判断间隔（ms） */
+#ifndef TM_CONFIG_WAIT_POLL_MS
+#define TM_CONFIG_WAIT_POLL_MS      1
+#endif
+
+/* 临界区保护（SysTick中断与主循环共享就绪/阻塞链表），主机构建时为空操作 */
+#ifndef TM_CRITICAL_ENTER
+#if TM_CONFIG_HOST_THREADS
+/* 主机多线程后端：调度器数据结构由一把全局递归互斥锁保护 */
+uint32_t TM_Host_Lock(void);
+void TM_Host_Unlock(uint32_t state);
+#define TM_CRITICAL_ENTER()         TM_Host_Lock()
+#define TM_CRITICAL_EXIT(state)     TM_Host_Unlock(state)
+#elif defined(__arm__) || defined(__ARMCC_VERSION) || defined(__ICCARM__)
+static inline uint32_t TM_Port_IrqSave(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+#define TM_CRITICAL_ENTER()         TM_Port_IrqSave()
+#define TM_CRITICAL_EXIT(state)     __set_PRIMASK(state)
+#else
+#define TM_CRITICAL_ENTER()         0U
+#define TM_CRITICAL_EXIT(state)     ((void)(state))
+#endif
+#endif
+
+/* 回绕安全的时间比较（HAL_GetTick()约49.7天回绕一次，要求两个时间点相差小于2^31 ms） */
+#define TM_TIME_AFTER_EQ(a, b)      ((int32_t)((uint32_t)(a) - (uint32_t)(b)) >= 0)
+#define TM_TIME_BEFORE(a, b)        ((int32_t)((uint32_t)(a) - (uint32_t)(b)) < 0)
+
 /* 任务状态枚举 */
 typedef enum {
     TASK_READY = 0,        // 就绪状态（可执行）
@@ -17,11 +145,44 @@ typedef enum {
     TASK_DELETED           // 已删除状态
 } TaskStatus;
 
+/* 周期任务的重装方式 */
+typedef enum {
+    TASK_PERIOD_FIXED_DELAY = 0,   // 固定间隔：下次运行 = 本次分派时间 + 周期（默认，延迟会累积漂移）
+    TASK_PERIOD_FIXED_RATE         // 固定速率：下次运行 = 上次应运行时间 + 周期（以截止时间为锚点，无漂移）
+} TaskPeriodMode;
+
+/* 固定速率任务错过一个或多个周期时的处理策略 */
+typedef enum {
+    TASK_OVERRUN_CATCH_UP = 0,     // 追赶：逐个补跑错过的周期，直到追上节拍
+    TASK_OVERRUN_SKIP              // 跳过：只补跑最近一个周期，其余丢弃（计入skipped_count）
+} TaskOverrunPolicy;
+
 /* 任务函数指针类型定义 */
 typedef void (*TaskFunction_t)(void* param);
 
+/* 睡眠函数类型：在关中断状态下调用，睡眠最多sleep_ms毫秒（中断可提前唤醒），
+ * 返回实际睡眠的毫秒数，并负责让HAL_GetTick()前进相同的时间 */
+typedef uint32_t (*TaskSleepHook_t)(uint32_t sleep_ms);
+
+/* 任务ID：高24位为槽位代数，低8位为槽位下标；任务删除后旧ID失效，槽位复用也不会误指向新任务 */
+typedef uint32_t TaskId_t;
+
+/* 无效任务ID */
+#define TASK_ID_INVALID             0U
+
+/* 等待超时：永久等待 */
+#define TM_WAIT_FOREVER             0xFFFFFFFFU
+
+/* 事件标志等待选项 */
+#define TM_EVENT_WAIT_ANY           0x00U   // 任一标志置位即满足
+#define TM_EVENT_WAIT_ALL           0x01U   // 全部标志置位才满足
+#define TM_EVENT_NO_CLEAR           0x02U   // 满足后不自动清除已匹配的标志
+
+/* 周期计数器读取函数类型（返回自由运行的32位计数值，如DWT->CYCCNT） */
+typedef uint32_t (*TaskCycleCounter_t)(void);
+
 /* 任务控制块结构体 */
-typedef struct {
+typedef struct TaskHandle {
     char name[16];                  // 任务名称
     TaskFunction_t function;        // 任务函数
     void* param;                    // 任务参数
@@ -29,37 +190,175 @@ typedef struct {
     uint32_t period;                // 周期性任务的周期时间（ms，0表示非周期任务）
     uint32_t next_run_time;         // 下次运行时间（系统滴答值）
     uint32_t run_count;             // 运行次数统计
+    TaskPeriodMode period_mode;     // 周期重装方式
+    TaskOverrunPolicy overrun_policy; // 固定速率模式下的超期处理策略
+    uint32_t last_lateness;         // 最近一次分派相对应运行时间的延迟（ms）
+    uint32_t max_lateness;          // 最大分派延迟（ms）
+    uint32_t missed_count;          // 错过截止时间的次数（延迟不小于一个周期）
+    uint32_t skipped_count;         // 按跳过策略丢弃的周期数
+#if TM_CONFIG_PROFILING
+    uint32_t exec_last;             // 最近一次执行耗时（CPU周期）
+    uint32_t exec_min;              // 最短执行耗时（CPU周期）
+    uint32_t exec_max;              // 最长执行耗时（CPU周期）
+    uint64_t exec_total;            // 累计执行耗时（CPU周期）
+#endif
     uint32_t timeout;               // 超时值（ms，用于阻塞时）
     TaskStatus status;              // 任务状态
     MSGQUEUE_HandleTypeDef* queue;  // 任务消息队列（可选）
     void* stack;                    // 任务栈（保留，用于将来扩展）
     uint32_t stack_size;            // 任务栈大小（保留，用于将来扩展）
     void* user_data;                // 用户自定义数据
+    uint16_t co_line;               // 协程续点（TM_BEGIN/TM_END 使用，0表示从头执行）
+    struct TaskHandle* list_next;   // 所在就绪链表的后继（内部使用）
+    struct TaskHandle* list_prev;   // 所在就绪链表的前驱（内部使用）
+    uint8_t list_id;                // 所在就绪链表/唤醒堆标识（内部使用）
+    uint8_t heap_index;             // 在唤醒堆中的下标（内部使用）
+    uint8_t slot;                   // 在任务数组中的槽位下标（内部使用）
+    uint8_t hash_next;              // 名称哈希链/空闲槽位链的下一个槽位（内部使用）
+    uint32_t generation;            // 槽位代数，任务删除时递增（内部使用）
+    uint32_t event_flags;           // 任务事件标志
+    uint32_t wait_mask;             // 等待的事件标志（内部使用）
+    uint8_t wait_type;              // 正在等待的对象：消息/事件（内部使用）
+    uint8_t wait_options;           // 事件等待选项（内部使用）
+    uint8_t wait_forever;           // 无超时等待，不进入唤醒堆（内部使用）
+    uint8_t excl_group;             // 互斥组（0表示不属于任何组，主机多线程后端使用）
 } TaskHandle_t;
 
+/* 任务统计信息 */
+typedef struct {
+    uint32_t run_count;             // 运行次数
+    uint32_t last_lateness;         // 最近一次分派延迟（ms）
+    uint32_t max_lateness;          // 最大分派延迟（ms）
+    uint32_t missed_count;          // 错过截止时间的次数
+    uint32_t skipped_count;         // 被跳过的周期数
+    uint32_t exec_last;             // 最近一次执行耗时（CPU周期，需启用TM_CONFIG_PROFILING）
+    uint32_t exec_min;              // 最短执行耗时（CPU周期）
+    uint32_t exec_max;              // 最长执行耗时（CPU周期）
+    uint32_t exec_avg;              // 平均执行耗时（CPU周期）
+} TaskStatistics_t;
+
+/* 任务链表（就绪桶） */
+typedef struct {
+    TaskHandle_t* head;             // 链表头
+    TaskHandle_t* tail;             // 链表尾
+} TaskList_t;
+
 /* 任务管理器结构体 */
 typedef struct {
-    TaskHandle_t* tasks;            // 任务数组
+    TaskHandle_t* tasks;            // 任务数组（槽位，删除任务不移动其他任务）
     uint8_t max_tasks;              // 最大任务数
     uint8_t task_count;             // 当前任务数
+    uint8_t slot_top;               // 曾使用过的槽位数，遍历任务数组的上界
+    uint8_t free_head;              // 空闲槽位链表头
+    uint8_t name_hash[TM_CONFIG_NAME_HASH_SIZE]; // 名称哈希桶（链头槽位）
     uint8_t current_task_index;     // 当前执行的任务索引
     uint8_t is_initialized;         // 初始化标志
     uint32_t task_switch_count;     // 任务切换计数
     uint32_t idle_count;            // 空闲计数
     uint8_t is_scheduling;          // 调度标志
+    uint8_t cpu_load;               // 上一统计窗口的CPU负载估计（%）
+    uint32_t load_window_start;     // 当前负载统计窗口起始时间
+    uint32_t load_idle_snapshot;    // 窗口起始时的空闲计数
+    uint32_t idle_peak;             // 单个窗口内观测到的最大空闲计数（视为0%负载）
+    uint32_t sleep_total_ms;        // 低功耗空闲累计睡眠时间（ms）
+    uint32_t sleep_count;           // 低功耗空闲睡眠次数
+    uint32_t load_sleep_snapshot;   // 窗口起始时的累计睡眠时间
+    uint8_t is_static;              // 任务数组/队列内存来自静态任务池
+    uint8_t task_peak;              // 任务数高水位
+    uint8_t* queue_arena;           // 静态任务池的队列内存区
+    uint32_t queue_arena_size;      // 队列内存区大小（字节）
+    uint32_t queue_arena_used;      // 队列内存区已用字节数
+    uint32_t queue_arena_peak;      // 队列内存区高水位（字节）
+#if TM_CONFIG_READY_QUEUE
+    TaskList_t ready_lists[TM_CONFIG_PRIO_LEVELS]; // 按优先级分桶的就绪链表
+    uint32_t ready_bitmap;          // 非空就绪桶位图（bit n 对应桶 n）
+    TaskHandle_t** delay_heap;      // 以next_run_time为键的阻塞任务最小堆
+    uint8_t delay_count;            // 唤醒堆中的任务数
+    uint8_t delay_peak;             // 唤醒堆高水位
+#endif
+#if TM_CONFIG_HOST_THREADS
+    uint32_t group_busy;            // 正在执行（或已被工作线程取走）的互斥组位图
+    uint8_t worker_count;           // 工作线程数
+#endif
 } TaskManager_t;
 
+/* 静态任务池：任务控制块、唤醒堆和任务消息队列的存储全部在链接时确定 */
+typedef struct {
+    TaskHandle_t* tasks;            // 任务控制块数组
+    TaskHandle_t** delay_heap;      // 唤醒堆数组
+    uint8_t max_tasks;              // 最大任务数（含空闲任务）
+    uint8_t* queue_arena;           // 队列内存区
+    uint32_t queue_arena_size;      // 队列内存区大小（字节）
+} TaskManager_Pool_t;
+
+/* 内存使用及高水位统计 */
+typedef struct {
+    uint8_t task_capacity;          // 任务容量
+    uint8_t task_count;             // 当前任务数
+    uint8_t task_peak;              // 任务数高水位
+    uint8_t delay_peak;             // 同时阻塞任务数高水位（仅就绪队列模式）
+    uint32_t queue_bytes_capacity;  // 队列内存区大小（仅静态任务池）
+    uint32_t queue_bytes_used;      // 队列内存区已用字节
+    uint32_t queue_bytes_peak;      // 队列内存区高水位
+} TaskManager_MemStats_t;
+
+/* 队列内存区的分配单元：按平台最大基本对齐，队列句柄和任意消息类型（含double、64位整数、指针）都能直接访问 */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+typedef max_align_t TM_PoolUnit_t;
+#define TM_POOL_ALIGN_BYTES         ((uint32_t)_Alignof(max_align_t))
+#else
+typedef union {
+    void* p;
+    uint64_t u;
+    double d;
+} TM_PoolUnit_t;
+#define TM_POOL_ALIGN_BYTES         ((uint32_t)sizeof(TM_PoolUnit_t))
+#endif
+
+/* 队列内存区按TM_POOL_ALIGN_BYTES对齐分配 */
+#define TM_POOL_ALIGN(size)         (((uint32_t)(size) + TM_POOL_ALIGN_BYTES - 1U) / TM_POOL_ALIGN_BYTES * TM_POOL_ALIGN_BYTES)
+
+/* 一个任务消息队列在静态任务池中占用的字节数，可用于计算queue_bytes */
+#define TM_POOL_QUEUE_BYTES(queue_size, msg_size) \
+    (TM_POOL_ALIGN(sizeof(MSGQUEUE_HandleTypeDef)) + TM_POOL_ALIGN(MSGQUEUE_STATIC_SIZE(queue_size, msg_size)))
+
+/**
+ * @brief  定义静态任务池（在文件作用域使用）
+ * @param  name: 任务池变量名，传给 TaskManager_InitStatic(&name)
+ * @param  n_tasks: 最大任务数（含空闲任务）
+ * @param  queue_bytes: 所有任务消息队列总字节数，可用 TM_POOL_QUEUE_BYTES() 累加
+ */
+#define TASKMANAGER_DEFINE_POOL(name, n_tasks, queue_bytes)                             \
+    static TaskHandle_t name##_tasks[(n_tasks)];                                        \
+    static TaskHandle_t* name##_delay_heap[TM_CONFIG_READY_QUEUE ? (n_tasks) : 1];      \
+    static TM_PoolUnit_t name##_queue_arena[((queue_bytes) + sizeof(TM_PoolUnit_t) - 1U) / sizeof(TM_PoolUnit_t) + 1U]; \
+    static TaskManager_Pool_t name = {                                                  \
+        name##_tasks, name##_delay_heap, (n_tasks),                                     \
+        (uint8_t*)name##_queue_arena, (uint32_t)(queue_bytes)                           \
+    }
+
 /* 全局任务管理器实例 */
 extern TaskManager_t g_task_manager;
 
 /* 函数声明 */
 
+#if !TM_CONFIG_STATIC_ONLY
 /**
  * @brief  初始化任务管理器
  * @param  max_tasks: 最大任务数量
  * @retval 0:成功 非0:失败
  */
 uint8_t TaskManager_Init(uint8_t max_tasks);
+#endif
+
+/**
+ * @brief  使用静态任务池初始化任务管理器（不使用堆内存）
+ * @param  pool: 由 TASKMANAGER_DEFINE_POOL() 定义的任务池
+ * @retval 0:成功 非0:失败
+ * @note   任务消息队列从任务池的队列内存区顺序分配；删除任务或重建队列时，
+ *         只有最后分配的队列内存能被回收
+ */
+uint8_t TaskManager_InitStatic(TaskManager_Pool_t* pool);
 
 /**
  * @brief  创建新任务
@@ -101,6 +400,16 @@ uint8_t TaskManager_ResumeTask(TaskHandle_t* task);
  */
 uint8_t TaskManager_SetTaskPeriod(TaskHandle_t* task, uint32_t period);
 
+/**
+ * @brief  设置周期任务的重装方式和超期策略
+ * @param  task: 任务句柄
+ * @param  mode: 重装方式（固定间隔/固定速率）
+ * @param  policy: 固定速率模式下错过周期时的处理策略
+ * @retval 0:成功 非0:失败
+ * @note   切换到固定速率时以当前的next_run_time作为节拍锚点
+ */
+uint8_t TaskManager_SetTaskPeriodMode(TaskHandle_t* task, TaskPeriodMode mode, TaskOverrunPolicy policy);
+
 /**
  * @brief  设置任务优先级
  * @param  task: 任务句柄
@@ -113,7 +422,7 @@ uint8_t TaskManager_SetTaskPriority(TaskHandle_t* task, uint32_t priority);
  * @brief  任务延时
  * @param  delay_ms: 延时时间（ms）
  * @retval 无
- * @note   仅在任务内部调用有效
+ * @note   仅在任务内部调用有效；延时在任务函数返回后生效，需在延时点继续执行请使用TM_DELAY()
  */
 void TaskManager_Delay(uint32_t delay_ms);
 
@@ -130,6 +439,21 @@ TaskHandle_t* TaskManager_GetCurrentTask(void);
  */
 TaskHandle_t* TaskManager_FindTaskByName(const char* name);
 
+/**
+ * @brief  获取任务ID
+ * @param  task: 任务句柄
+ * @retval 任务ID（TASK_ID_INVALID表示任务无效）
+ * @note   长期保存任务引用时应保存ID而非句柄指针：任务删除后槽位会被新任务复用
+ */
+TaskId_t TaskManager_GetTaskId(TaskHandle_t* task);
+
+/**
+ * @brief  根据任务ID获取任务句柄
+ * @param  id: 任务ID
+ * @retval 任务句柄（NULL表示任务已删除或ID无效）
+ */
+TaskHandle_t* TaskManager_GetTaskById(TaskId_t id);
+
 /**
  * @brief  创建任务消息队列
  * @param  task: 任务句柄
@@ -144,7 +468,7 @@ uint8_t TaskManager_CreateTaskQueue(TaskHandle_t* task, uint16_t queue_size, uin
  * @param  task: 目标任务句柄
  * @param  msg: 消息数据
  * @param  size: 消息大小
- * @param  priority: 消息优先级
+ * @param  priority: 消息优先级（数值越大越先被接收，TM_CONFIG_QUEUE_PRIORITY为0时只被记录）
  * @retval 0:成功 非0:失败
  */
 uint8_t TaskManager_SendTaskMessage(TaskHandle_t* task, const void* msg, uint16_t size, uint32_t priority);
@@ -159,6 +483,66 @@ uint8_t TaskManager_SendTaskMessage(TaskHandle_t* task, const void* msg, uint16_
  */
 uint8_t TaskManager_ReceiveTaskMessage(TaskHandle_t* task, void* buffer, uint16_t size, uint16_t* received_size);
 
+/**
+ * @brief  设置任务所属的互斥组
+ * @param  task: 任务句柄
+ * @param  group: 互斥组（1~32，0表示不属于任何组）
+ * @retval 0:成功 非0:失败
+ * @note   主机多线程后端中同一互斥组的任务不会同时执行（如共用同一个驱动/总线的任务）；
+ *         单线程调度时任务本来就不会并行，设置无影响
+ */
+uint8_t TaskManager_SetTaskGroup(TaskHandle_t* task, uint8_t group);
+
+/**
+ * @brief  设置主机多线程后端的工作线程数（需在TaskManager_StartScheduler()前调用）
+ * @param  count: 工作线程数（1~TM_CONFIG_HOST_MAX_WORKERS）
+ * @retval 0:成功 非0:失败
+ */
+uint8_t TaskManager_SetWorkerCount(uint8_t count);
+
+/**
+ * @brief  等待当前任务的消息队列中有消息
+ * @param  timeout: 超时时间（ms），TM_WAIT_FOREVER表示永久等待，0表示不等待
+ * @retval 0:已有消息 1:队列为空（timeout非0时任务已阻塞，应返回调度器） 其他:错误
+ * @note   仅在任务内部调用有效；阻塞后 TaskManager_SendTaskMessage() 会立即把任务转为就绪，
+ *         超时也会就绪，任务恢复后应重新读取队列判断是否收到消息
+ */
+uint8_t TaskManager_WaitMessage(uint32_t timeout);
+
+/**
+ * @brief  设置任务事件标志（可在中断中调用）
+ * @param  task: 任务句柄
+ * @param  flags: 要置位的标志
+ * @retval 0:成功 非0:失败
+ * @note   目标任务正在等待且等待条件满足时立即转为就绪
+ */
+uint8_t TaskManager_SetEvents(TaskHandle_t* task, uint32_t flags);
+
+/**
+ * @brief  清除任务事件标志（可在中断中调用）
+ * @param  task: 任务句柄
+ * @param  flags: 要清除的标志
+ * @retval 清除前的事件标志
+ */
+uint32_t TaskManager_ClearEvents(TaskHandle_t* task, uint32_t flags);
+
+/**
+ * @brief  获取任务事件标志
+ * @param  task: 任务句柄
+ * @retval 当前事件标志
+ */
+uint32_t TaskManager_GetEvents(TaskHandle_t* task);
+
+/**
+ * @brief  等待当前任务的事件标志
+ * @param  mask: 等待的标志
+ * @param  options: TM_EVENT_WAIT_ANY/TM_EVENT_WAIT_ALL，可或上TM_EVENT_NO_CLEAR
+ * @param  timeout: 超时时间（ms），TM_WAIT_FOREVER表示永久等待，0表示不等待
+ * @retval 满足条件时返回匹配的标志（默认同时清除）；不满足或mask为0时返回0（timeout非0且mask非0时任务已阻塞，应返回调度器）
+ * @note   仅在任务内部调用有效
+ */
+uint32_t TaskManager_WaitEvents(uint32_t mask, uint8_t options, uint32_t timeout);
+
 /**
  * @brief  任务调度器
  * @retval 无
@@ -185,6 +569,21 @@ void TaskManager_StopScheduler(void);
  */
 void TaskManager_GetTaskStats(TaskHandle_t* task, uint32_t* run_count);
 
+/**
+ * @brief  获取任务扩展统计信息（运行次数、分派延迟、错过/跳过的周期数）
+ * @param  task: 任务句柄
+ * @param  stats: 统计信息输出
+ * @retval 无
+ */
+void TaskManager_GetTaskStatsEx(TaskHandle_t* task, TaskStatistics_t* stats);
+
+/**
+ * @brief  清零任务统计信息
+ * @param  task: 任务句柄
+ * @retval 无
+ */
+void TaskManager_ResetTaskStats(TaskHandle_t* task);
+
 /**
  * @brief  获取系统统计信息
  * @param  task_switch_count: 任务切换次数
@@ -193,10 +592,179 @@ void TaskManager_GetTaskStats(TaskHandle_t* task, uint32_t* run_count);
  */
 void TaskManager_GetSystemStats(uint32_t* task_switch_count, uint32_t* idle_count);
 
+/**
+ * @brief  获取内存使用及高水位统计
+ * @param  stats: 统计信息输出
+ * @retval 无
+ */
+void TaskManager_GetMemStats(TaskManager_MemStats_t* stats);
+
+/**
+ * @brief  获取CPU负载估计
+ * @retval 上一统计窗口的CPU负载（0~100%）
+ * @note   根据每个窗口内空闲任务的运行次数估计：负载 = 1 - 空闲计数 / 空闲计数峰值。
+ *         峰值自动取历史最大值，也可用TaskManager_SetIdleReference()指定满空闲时的计数
+ */
+uint8_t TaskManager_GetCpuLoad(void);
+
+/**
+ * @brief  设置满空闲（0%负载）时单个统计窗口内的空闲计数参考值
+ * @param  idle_per_window: 参考空闲计数，0表示恢复自动学习
+ * @retval 无
+ */
+void TaskManager_SetIdleReference(uint32_t idle_per_window);
+
+/**
+ * @brief  设置执行时间统计使用的周期计数器
+ * @param  counter: 计数器读取函数，NULL表示不统计
+ * @retval 无
+ * @note   Cortex-M3/M4上默认读取DWT->CYCCNT，需先调用DWT_Delay_Init()使能计数器；
+ *         主机构建时可传入基于clock_gettime()等的计数函数
+ */
+void TaskManager_SetCycleCounter(TaskCycleCounter_t counter);
+
+/**
+ * @brief  设置低功耗空闲的睡眠函数（需启用TM_CONFIG_TICKLESS）
+ * @param  hook: 睡眠函数，NULL表示空闲时不睡眠
+ * @retval 无
+ * @note   Cortex-M上默认暂停SysTick节拍并执行WFI，醒来后补偿HAL滴答；
+ *         主机构建可传入推进虚拟时钟的函数
+ */
+void TaskManager_SetSleepHook(TaskSleepHook_t hook);
+
+/**
+ * @brief  获取低功耗空闲统计
+ * @param  sleep_ms: 累计睡眠时间输出（ms，可为NULL）
+ * @param  sleep_count: 睡眠次数输出（可为NULL）
+ * @retval 无
+ */
+void TaskManager_GetSleepStats(uint32_t* sleep_ms, uint32_t* sleep_count);
+
+/**
+ * @brief  以类似top的表格输出系统负载和各任务统计信息（通过TM_PRINTF）
+ * @retval 无
+ */
+void TaskManager_DumpStats(void);
+
 /**
  * @brief  任务管理器周期性更新（在systick中断中调用）
  * @retval 无
  */
 void TaskManager_Update(void);
 
+/* 无栈协程任务 -----------------------------------------------------------
+ *
+ * 在任务函数中用 TM_BEGIN()/TM_END() 包围函数体，即可在其中使用 TM_YIELD()、
+ * TM_DELAY()、TM_WAIT_UNTIL()、TM_WAIT_MSG()：这些宏记录续点后直接返回调度器，
+ * 下次分派时从续点处继续执行，不会嵌套调用栈（Duff's device / protothread 方式）。
+ *
+ * 注意：
+ * - 局部变量在让出后不保留，需要跨越让出点的数据请放在static变量或任务参数中
+ * - 协程函数体内不能再使用跨越让出点的 switch 语句
+ * - 协程任务一般以周期0创建；周期任务中 TM_YIELD() 会等到下一个周期再继续
+ */
+
+/**
+ * @brief  协程宏的使用错误：通过TM_PRINTF输出错误，复位续点并挂起任务
+ * @param  task: 出错的任务
+ * @param  what: 错误说明
+ * @retval 无
+ * @note   由协程宏内部调用，挂起后可修正原因（如创建消息队列）再恢复任务
+ */
+void TaskManager_CoroutineError(TaskHandle_t* task, const char* what);
+
+/* 协程开始 */
+#define TM_BEGIN()                                                      \
+    TaskHandle_t* tm_self_ = TaskManager_GetCurrentTask();              \
+    if (tm_self_ == NULL) {                                             \
+        return;                                                         \
+    }                                                                   \
+    switch (tm_self_->co_line) {                                        \
+    case 0:
+
+/* 协程结束：复位续点，下次分派从头执行 */
+#define TM_END()                                                        \
+    }                                                                   \
+    tm_self_->co_line = 0;                                              \
+    return
+
+/* 让出CPU，下次分派时从此处继续 */
+#define TM_YIELD()                                                      \
+    do {                                                                \
+        tm_self_->co_line = __LINE__;                                   \
+        return;                                                         \
+    case __LINE__:;                                                     \
+    } while (0)
+
+/* 延时ms毫秒后从此处继续（期间不占用调度） */
+#define TM_DELAY(ms)                                                    \
+    do {                                                                \
+        tm_self_->co_line = __LINE__;                                   \
+        TaskManager_Delay(ms);                                          \
+        return;                                                         \
+    case __LINE__:;                                                     \
+    } while (0)
+
+/* 等待条件成立，不成立时阻塞TM_CONFIG_WAIT_POLL_MS后重新判断（不会饿死低优先级任务） */
+#define TM_WAIT_UNTIL(cond)                                             \
+    do {                                                                \
+        tm_self_->co_line = __LINE__;                                   \
+    case __LINE__:                                                      \
+        if (!(cond)) {                                                  \
+            TaskManager_Delay(TM_CONFIG_WAIT_POLL_MS);                  \
+            return;                                                     \
+        }                                                               \
+    } while (0)
+
+/* 等待任务消息队列中有消息（之后用TaskManager_ReceiveTaskMessage读取），等待期间不占用调度；
+   任务没有消息队列时输出错误并挂起任务，而不是每次分派都空转 */
+#define TM_WAIT_MSG()                                                   \
+    do {                                                                \
+        tm_self_->co_line = __LINE__;                                   \
+    case __LINE__: {                                                    \
+        uint8_t tm_wait_ = TaskManager_WaitMessage(TM_WAIT_FOREVER);    \
+        if (tm_wait_ == 1) {                                            \
+            return;                                                     \
+        }                                                               \
+        if (tm_wait_ != 0) {                                            \
+            TaskManager_CoroutineError(tm_self_, "TM_WAIT_MSG: no message queue"); \
+            return;                                                     \
+        }                                                               \
+    }                                                                   \
+    } while (0)
+
+/* 等待消息最多ms毫秒，收到消息或超时后继续（需自行读取队列判断是否收到） */
+#define TM_WAIT_MSG_TIMEOUT(ms)                                         \
+    do {                                                                \
+        tm_self_->co_line = __LINE__;                                   \
+        if (TaskManager_WaitMessage(ms) == 1) {                         \
+            return;                                                     \
+        }                                                               \
+    case __LINE__:;                                                     \
+    } while (0)
+
+/* 等待事件标志，满足后把匹配的标志存入result继续执行（mask为0时永远不会满足，按使用错误挂起任务） */
+#define TM_WAIT_EVENTS(mask, options, result)                           \
+    do {                                                                \
+        tm_self_->co_line = __LINE__;                                   \
+    case __LINE__: {                                                    \
+        uint32_t tm_mask_ = (mask);                                     \
+        if (tm_mask_ == 0) {                                            \
+            TaskManager_CoroutineError(tm_self_, "TM_WAIT_EVENTS: empty mask"); \
+            return;                                                     \
+        }                                                               \
+        (result) = TaskManager_WaitEvents(tm_mask_, (options), TM_WAIT_FOREVER); \
+        if ((result) == 0) {                                            \
+            return;                                                     \
+        }                                                               \
+    }                                                                   \
+    } while (0)
+
+/* 从头重新开始协程 */
+#define TM_RESTART()                                                    \
+    do {                                                                \
+        tm_self_->co_line = 0;                                          \
+        return;                                                         \
+    } while (0)
+
 #endif /* __TASKMANAGER_H */ 
\ No newline at end of file